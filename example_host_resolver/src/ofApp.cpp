@@ -0,0 +1,222 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+#include "Poco/Net/NetException.h"
+
+
+StubResolver::StubResolver():
+    _state(std::make_shared<State>())
+{
+}
+
+
+ofxNet::AsyncHostResolver::Backend StubResolver::backend()
+{
+    std::shared_ptr<State> state = _state;
+
+    return [state](const ofxNet::AsyncHostResolver::Query& query) {
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            ++state->calls[query.host];
+            ++state->running;
+            state->maximumConcurrency = std::max(state->maximumConcurrency, state->running);
+            state->condition.notify_all();
+            state->condition.wait(lock, [&]() { return state->held.count(query.host) == 0; });
+        }
+
+        // Long enough for concurrent lookups to overlap.
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            --state->running;
+        }
+
+        if (query.host.size() > 8 && query.host.compare(query.host.size() - 8, 8, ".missing") == 0)
+            throw Poco::Net::HostNotFoundException(query.host);
+
+        char* aliases[] = { nullptr };
+        char* addresses[] = { nullptr };
+
+        hostent entry = {};
+        entry.h_name = const_cast<char*>(query.host.c_str());
+        entry.h_aliases = aliases;
+        entry.h_addrtype = AF_INET;
+        entry.h_length = 4;
+        entry.h_addr_list = addresses;
+
+        return ofxNet::AsyncHostResolver::HostEntry(&entry);
+    };
+}
+
+
+void StubResolver::hold(const std::string& host)
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->held.insert(host);
+}
+
+
+void StubResolver::release(const std::string& host)
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->held.erase(host);
+    _state->condition.notify_all();
+}
+
+
+void StubResolver::waitForCall(const std::string& host)
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->condition.wait(lock, [&]() { return _state->calls[host] > 0; });
+}
+
+
+std::size_t StubResolver::calls(const std::string& host) const
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    auto iter = _state->calls.find(host);
+    return iter != _state->calls.end() ? iter->second : 0;
+}
+
+
+std::size_t StubResolver::maximumConcurrency() const
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    return _state->maximumConcurrency;
+}
+
+
+void ofApp::setup()
+{
+    typedef ofxNet::AsyncHostResolver::Status Status;
+
+    StubResolver stub;
+
+    ofxNet::AsyncHostResolver::Settings settings;
+    settings.threadCount = 1;
+    settings.maximumQueueSize = 2;
+    settings.defaultTimeout = std::chrono::milliseconds(5000);
+    settings.backend = stub.backend();
+
+    ofxNet::AsyncHostResolver resolver(settings);
+
+    // A lookup completes with the backend's host entry.
+    {
+        auto result = resolver.getHostByName("example.test").future().get();
+        check("success", result.success() && result.hostEntry.name() == "example.test");
+
+        result = resolver.getHostByName("example.missing").future().get();
+        check("not found", result.status == Status::NOT_FOUND);
+    }
+
+    // A request times out while its lookup is still running.
+    {
+        stub.hold("slow.test");
+
+        auto request = resolver.submit({ ofxNet::AsyncHostResolver::QueryType::HOST_BY_NAME, "slow.test" },
+                                       std::chrono::milliseconds(50));
+
+        check("timeout", request.future().get().status == Status::TIMEOUT);
+
+        stub.release("slow.test");
+    }
+
+    // The single worker is held, so the following lookups stay queued.
+    stub.hold("busy.test");
+    auto busy = resolver.getHostByName("busy.test");
+    stub.waitForCall("busy.test");
+
+    // Identical requests share one lookup.
+    std::vector<ofxNet::AsyncHostResolver::Request> duplicates;
+
+    for (int i = 0; i < 5; ++i)
+        duplicates.push_back(resolver.getHostByName("dedup.test"));
+
+    // A cancelled request completes at once and its lookup is skipped.
+    auto cancelled = resolver.getHostByName("cancel.test");
+
+    check("cancel", cancelled.cancel() && cancelled.future().get().status == Status::CANCELLED);
+
+    // dedup.test and cancel.test fill the queue. The cancelled lookup is
+    // pruned to make room for the next one, and the one after is rejected.
+    auto admitted = resolver.getHostByName("first.test");
+    auto rejected = resolver.getHostByName("second.test");
+
+    check("queue full", admitted.future().wait_for(std::chrono::milliseconds(0)) != std::future_status::ready
+                     && rejected.future().get().status == Status::REJECTED);
+
+    stub.release("busy.test");
+
+    bool allSucceeded = busy.future().get().success();
+
+    for (auto& request: duplicates)
+        allSucceeded = allSucceeded && request.future().get().success();
+
+    check("dedup", allSucceeded && stub.calls("dedup.test") == 1);
+    check("cancelled lookup skipped", admitted.future().get().success() && stub.calls("cancel.test") == 0);
+
+    checkBatch();
+
+    std::cout << results.str();
+}
+
+
+void ofApp::checkBatch()
+{
+    StubResolver stub;
+
+    // More workers than queue slots, so the queue size is the tighter cap.
+    ofxNet::AsyncHostResolver::Settings settings;
+    settings.threadCount = 4;
+    settings.maximumQueueSize = 2;
+    settings.backend = stub.backend();
+
+    ofxNet::AsyncHostResolver resolver(settings);
+
+    // Every address appears twice.
+    std::vector<Poco::Net::IPAddress> addresses;
+
+    for (int i = 0; i < 40; ++i)
+        addresses.push_back(Poco::Net::IPAddress("192.0.2." + ofToString(1 + i % 20)));
+
+    auto results = resolver.getHostsByAddress(addresses, 16);
+
+    bool inOrder = results.size() == addresses.size();
+    bool deduplicated = true;
+    bool admitted = true;
+
+    for (std::size_t i = 0; i < addresses.size(); ++i)
+    {
+        const std::string host = addresses[i].toString();
+        admitted = admitted && results[i].status != ofxNet::AsyncHostResolver::Status::REJECTED;
+        inOrder = inOrder && results[i].success() && results[i].hostEntry.name() == host;
+        deduplicated = deduplicated && stub.calls(host) == 1;
+    }
+
+    check("batch results in input order", inOrder);
+    check("batch duplicates looked up once", deduplicated);
+    check("batch never rejected", admitted);
+    check("batch in-flight window capped at the queue size", stub.maximumConcurrency() <= settings.maximumQueueSize);
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofDrawBitmapString(results.str(), 14, 14);
+}
+
+
+void ofApp::check(const std::string& name, bool passed)
+{
+    if (!passed)
+        ++failures;
+
+    results << (passed ? "PASS " : "FAIL ") << name << std::endl;
+}
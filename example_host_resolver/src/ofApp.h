@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include "ofMain.h"
+#include "ofxNetworkUtils.h"
+
+
+/// \brief A stand-in resolver, so AsyncHostResolver can be exercised
+///        without a network.
+///
+/// Every lookup succeeds with a host entry named after the query, except
+/// names ending in ".missing", which are not found. Lookups for held names
+/// block until they are released.
+class StubResolver
+{
+public:
+    StubResolver();
+
+    /// \returns a backend for AsyncHostResolver::Settings.
+    ofxNet::AsyncHostResolver::Backend backend();
+
+    /// \brief Block lookups of a name until it is released.
+    void hold(const std::string& host);
+
+    /// \brief Let blocked lookups of a name return.
+    void release(const std::string& host);
+
+    /// \brief Wait until a lookup of a name has started.
+    void waitForCall(const std::string& host);
+
+    /// \returns the number of lookups of a name.
+    std::size_t calls(const std::string& host) const;
+
+    /// \returns the largest number of lookups that ran at once.
+    std::size_t maximumConcurrency() const;
+
+private:
+    struct State
+    {
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::set<std::string> held;
+        std::map<std::string, std::size_t> calls;
+        std::size_t running = 0;
+        std::size_t maximumConcurrency = 0;
+    };
+
+    std::shared_ptr<State> _state;
+
+};
+
+
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Check getHostsByAddress() against a stand-in resolver.
+    void checkBatch();
+
+    /// \brief Record the outcome of a check.
+    /// \param name The name of the check.
+    /// \param passed True iff the check passed.
+    void check(const std::string& name, bool passed);
+
+    std::stringstream results;
+
+    std::size_t failures = 0;
+
+};
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+
+
+// The difference is small on a laptop with a handful of interfaces. To see it
+// on a host with many, run the app as root inside a network namespace filled
+// with veth pairs:
+//
+//     ip netns add bench
+//     ip netns exec bench sh -c 'for i in $(seq 1 100); do
+//         ip link add veth$i type veth peer name veth${i}p
+//         ip addr add 10.$((i / 250)).$((i % 250)).1/24 dev veth$i
+//         ip link set veth$i up
+//         ip link set veth${i}p up
+//     done'
+//     ip netns exec bench ./bin/example_interface_benchmark
+//     ip netns del bench
+void ofApp::setup()
+{
+    const std::size_t iterations = 200;
+
+    results << "Enumerations per test: " << iterations << std::endl << std::endl;
+
+    // The existing path, one Poco::Net::NetworkInterface::map() per call.
+    {
+        std::size_t interfaces = 0;
+        uint64_t start = ofGetElapsedTimeMicros();
+
+        for (std::size_t i = 0; i < iterations; ++i)
+            interfaces = Poco::Net::NetworkInterface::map().size();
+
+        addResult("NetworkInterface::map", iterations, interfaces, ofGetElapsedTimeMicros() - start);
+    }
+
+    for (auto backend: { ofxNet::NetworkInterfaceEnumerator::POCO,
+                         ofxNet::NetworkInterfaceEnumerator::NETLINK })
+    {
+        std::string name = backend == ofxNet::NetworkInterfaceEnumerator::POCO ? "POCO" : "NETLINK";
+
+        if (!ofxNet::NetworkInterfaceEnumerator::isAvailable(backend))
+        {
+            results << name << " is not supported." << std::endl;
+            continue;
+        }
+
+        ofxNet::NetworkInterfaceEnumerator enumerator(backend);
+        ofxNet::NetworkInterfaceInfo::List interfaces;
+
+        // A failed NETLINK dump falls back to POCO, which would be timed
+        // under the wrong name, so count both.
+        std::size_t failures = 0;
+        std::size_t fallbacks = 0;
+
+        uint64_t start = ofGetElapsedTimeMicros();
+
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            if (!enumerator.enumerate(interfaces))
+                ++failures;
+            else if (enumerator.lastBackend() != backend)
+                ++fallbacks;
+        }
+
+        uint64_t micros = ofGetElapsedTimeMicros() - start;
+
+        if (failures > 0 || fallbacks > 0)
+        {
+            results << std::setw(36) << std::left << ("NetworkInterfaceEnumerator " + name);
+            results << "INVALID: " << failures << " failed, " << fallbacks << " fell back to POCO" << std::endl;
+            continue;
+        }
+
+        addResult("NetworkInterfaceEnumerator " + name, iterations, interfaces.size(), micros);
+    }
+
+    std::cout << results.str();
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofDrawBitmapString(results.str(), 14, 14);
+}
+
+
+void ofApp::addResult(const std::string& name,
+                      std::size_t iterations,
+                      std::size_t interfaces,
+                      uint64_t micros)
+{
+    double microsPerCall = iterations > 0 ? double(micros) / iterations : 0;
+
+    results << std::setw(36) << std::left << name;
+    results << std::setw(10) << std::right << micros << " us ";
+    results << std::setw(10) << std::fixed << std::setprecision(1) << microsPerCall << " us/call";
+    results << " (" << interfaces << " interfaces)";
+    results << std::endl;
+}
@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxNetworkUtils.h"
+
+
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Record a timing measurement.
+    /// \param name The name of the measured path.
+    /// \param iterations The number of enumerations.
+    /// \param interfaces The number of interfaces found.
+    /// \param micros The elapsed time in microseconds.
+    void addResult(const std::string& name,
+                   std::size_t iterations,
+                   std::size_t interfaces,
+                   uint64_t micros);
+
+    std::stringstream results;
+
+};
@@ -12,6 +12,8 @@ void ofApp::setup()
 {
     interfaceUpListener = networkInterfaceListener.onInterfaceUp.newListener(this, &ofApp::onInterfaceUp);
     interfaceDownListener = networkInterfaceListener.onInterfaceDown.newListener(this, &ofApp::onInterfaceDown);
+    addressAddedListener = networkInterfaceListener.onAddressAdded.newListener(this, &ofApp::onAddressAdded);
+    addressRemovedListener = networkInterfaceListener.onAddressRemoved.newListener(this, &ofApp::onAddressRemoved);
 }
 
 
@@ -66,3 +68,14 @@ void ofApp::onInterfaceDown(const Poco::Net::NetworkInterface& interface)
     ofLogNotice("ofApp::onInterfaceDown") << interface.displayName() << " went down.";
 }
 
+
+void ofApp::onAddressAdded(const ofxNet::NetworkInterfaceEvent& event)
+{
+    ofLogNotice("ofApp::onAddressAdded") << event.info.name << " gained " << event.address.address.toString();
+}
+
+
+void ofApp::onAddressRemoved(const ofxNet::NetworkInterfaceEvent& event)
+{
+    ofLogNotice("ofApp::onAddressRemoved") << event.info.name << " lost " << event.address.address.toString();
+}
@@ -20,10 +20,14 @@ public:
 
     void onInterfaceUp(const Poco::Net::NetworkInterface& interface);
     void onInterfaceDown(const Poco::Net::NetworkInterface& interface);
+    void onAddressAdded(const ofxNet::NetworkInterfaceEvent& event);
+    void onAddressRemoved(const ofxNet::NetworkInterfaceEvent& event);
 
     ofxNet::NetworkInterfaceListener networkInterfaceListener;
 
     ofEventListener interfaceUpListener;
     ofEventListener interfaceDownListener;
+    ofEventListener addressAddedListener;
+    ofEventListener addressRemovedListener;
 
 };
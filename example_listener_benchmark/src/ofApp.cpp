@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+
+
+// Synthetic interfaces need no network hardware or privileges. To replay a
+// sequence recorded elsewhere, save it with
+// SyntheticNetworkInterfaceSource::save() as bin/data/recording.txt.
+void ofApp::setup()
+{
+    const std::size_t changes = 500;
+    const uint32_t seed = 1;
+
+    results << "Changes per test: " << changes << std::endl;
+    results << "publish: building the snapshot, diff: detecting and delivering," << std::endl;
+    results << "latency: from publishing to the subscriber, per event." << std::endl << std::endl;
+
+    results << std::setw(24) << std::left << "interfaces";
+    results << std::setw(14) << std::right << "publish us";
+    results << std::setw(14) << "diff us";
+    results << std::setw(14) << "latency us";
+    results << std::setw(14) << "max us";
+    results << std::setw(10) << "events";
+    results << std::endl;
+
+    for (std::size_t count: { 10, 100, 1000, 10000, 50000 })
+        replay(ofToString(count), ofxNet::SyntheticNetworkInterfaceSource::generate(count, changes, seed));
+
+    ofxNet::SyntheticNetworkInterfaceSource::Recording recording;
+    const std::string path = ofToDataPath("recording.txt", true);
+
+    if (ofFile::doesFileExist(path) && ofxNet::SyntheticNetworkInterfaceSource::load(path, recording))
+        replay("recording.txt", recording);
+
+    std::cout << results.str();
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofDrawBitmapString(results.str(), 14, 14);
+}
+
+
+void ofApp::replay(const std::string& name,
+                   const ofxNet::SyntheticNetworkInterfaceSource::Recording& recording)
+{
+    auto source = std::make_shared<ofxNet::SyntheticNetworkInterfaceSource>();
+
+    // MANUAL threading, so each change is detected and delivered by one
+    // process() call on this thread.
+    ofxNet::NetworkInterfaceListener listener(source,
+                                              ofxNet::NetworkInterfaceListener::NOTIFICATION,
+                                              ofxNet::NetworkInterfaceListener::MANUAL);
+
+    uint64_t published = 0;
+    uint64_t latency = 0;
+    uint64_t maximumLatency = 0;
+    std::size_t events = 0;
+
+    listener.subscribe(ofxNet::NetworkInterfaceFilter(), [&](const ofxNet::NetworkInterfaceEvent&) {
+        uint64_t elapsed = ofGetElapsedTimeMicros() - published;
+        latency += elapsed;
+        maximumLatency = std::max(maximumLatency, elapsed);
+        ++events;
+    });
+
+    source->play(recording);
+    listener.process();
+
+    latency = 0;
+    maximumLatency = 0;
+    events = 0;
+
+    uint64_t publishMicros = 0;
+    uint64_t diffMicros = 0;
+    std::size_t steps = 0;
+
+    while (true)
+    {
+        published = ofGetElapsedTimeMicros();
+
+        if (!source->step())
+            break;
+
+        uint64_t start = ofGetElapsedTimeMicros();
+        listener.process();
+        uint64_t end = ofGetElapsedTimeMicros();
+
+        publishMicros += start - published;
+        diffMicros += end - start;
+        ++steps;
+    }
+
+    double perStep = steps > 0 ? 1.0 / steps : 0;
+    double perEvent = events > 0 ? 1.0 / events : 0;
+
+    results << std::setw(24) << std::left << name;
+    results << std::fixed << std::setprecision(1) << std::right;
+    results << std::setw(14) << publishMicros * perStep;
+    results << std::setw(14) << diffMicros * perStep;
+    results << std::setw(14) << latency * perEvent;
+    results << std::setw(14) << maximumLatency;
+    results << std::setw(10) << events;
+    results << std::endl;
+}
@@ -0,0 +1,29 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxNetworkUtils.h"
+
+
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Replay a recording through a listener and record the timings.
+    /// \param name The name of the recording.
+    /// \param recording The recording.
+    void replay(const std::string& name,
+                const ofxNet::SyntheticNetworkInterfaceSource::Recording& recording);
+
+    std::stringstream results;
+
+};
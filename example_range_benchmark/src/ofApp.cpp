@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#include "ofApp.h"
+
+
+void ofApp::setup()
+{
+    const std::size_t count = 1 << 20;
+
+    // Half of the addresses fall inside of the test ranges.
+    std::vector<uint32_t> addressesIPv4(count);
+    std::vector<uint8_t> addressesIPv6(count * 16);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&addressesIPv4[i]);
+        uint8_t* bytesIPv6 = &addressesIPv6[i * 16];
+
+        for (std::size_t j = 0; j < 4; ++j)
+            bytes[j] = static_cast<uint8_t>(ofRandom(256));
+
+        for (std::size_t j = 0; j < 16; ++j)
+            bytesIPv6[j] = static_cast<uint8_t>(ofRandom(256));
+
+        if (i % 2 == 0)
+        {
+            bytes[0] = 10;
+            bytes[1] = 1;
+            bytesIPv6[0] = 0x20;
+            bytesIPv6[1] = 0x01;
+            bytesIPv6[2] = 0x0d;
+            bytesIPv6[3] = 0xb8;
+        }
+    }
+
+    ofxNet::IPAddressRange rangeIPv4("10.1.0.0/16");
+    ofxNet::IPAddressRange rangeIPv6("2001:db8::/32");
+
+    results << "Addresses per test: " << count << std::endl << std::endl;
+
+    // The existing scalar path, one Poco::Net::IPAddress per address.
+    {
+        std::vector<Poco::Net::IPAddress> addresses;
+        addresses.reserve(count);
+
+        for (auto address: addressesIPv4)
+            addresses.push_back(Poco::Net::IPAddress(&address, 4));
+
+        std::size_t matches = 0;
+        uint64_t start = ofGetElapsedTimeMicros();
+
+        for (const auto& address: addresses)
+            matches += rangeIPv4.contains(address);
+
+        addResult("IPv4 IPAddressRange::contains", count, matches, ofGetElapsedTimeMicros() - start);
+    }
+
+    {
+        std::vector<Poco::Net::IPAddress> addresses;
+        addresses.reserve(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+            addresses.push_back(Poco::Net::IPAddress(&addressesIPv6[i * 16], 16));
+
+        std::size_t matches = 0;
+        uint64_t start = ofGetElapsedTimeMicros();
+
+        for (const auto& address: addresses)
+            matches += rangeIPv6.contains(address);
+
+        addResult("IPv6 IPAddressRange::contains", count, matches, ofGetElapsedTimeMicros() - start);
+    }
+
+    results << std::endl;
+
+    std::vector<uint64_t> bitmap(ofxNet::IPAddressRangeBatch::bitmapSize(count));
+
+    for (auto kernel: { ofxNet::IPAddressRangeBatch::Kernel::SCALAR,
+                        ofxNet::IPAddressRangeBatch::Kernel::SSE2,
+                        ofxNet::IPAddressRangeBatch::Kernel::AVX2 })
+    {
+        std::string name = ofxNet::IPAddressRangeBatch::toString(kernel);
+
+        if (!ofxNet::IPAddressRangeBatch::setKernel(kernel))
+        {
+            results << name << " is not supported." << std::endl;
+            continue;
+        }
+
+        uint64_t start = ofGetElapsedTimeMicros();
+        std::size_t matches = ofxNet::IPAddressRangeBatch::containsIPv4(rangeIPv4.compact(), addressesIPv4.data(), count, bitmap.data());
+        addResult("IPv4 batch " + name, count, matches, ofGetElapsedTimeMicros() - start);
+
+        start = ofGetElapsedTimeMicros();
+        matches = ofxNet::IPAddressRangeBatch::containsIPv6(rangeIPv6.compact(), addressesIPv6.data(), count, bitmap.data());
+        addResult("IPv6 batch " + name, count, matches, ofGetElapsedTimeMicros() - start);
+    }
+
+    ofxNet::IPAddressRangeBatch::setKernel(ofxNet::IPAddressRangeBatch::bestKernel());
+
+    results << std::endl;
+
+    // Longest-prefix-match over a large list of random ranges.
+    {
+        const std::size_t rangeCount = 100000;
+
+        ofxNet::IPAddressRange::List ranges;
+        std::vector<uint32_t> values;
+
+        for (std::size_t i = 0; i < rangeCount; ++i)
+        {
+            uint8_t bytes[4];
+
+            for (std::size_t j = 0; j < 4; ++j)
+                bytes[j] = static_cast<uint8_t>(ofRandom(256));
+
+            ranges.push_back(ofxNet::CompactIPAddressRange(ofxNet::CompactIPAddress(bytes, 4), 8 + static_cast<unsigned>(ofRandom(25))));
+            values.push_back(static_cast<uint32_t>(i));
+        }
+
+        ofxNet::IPAddressRangeTable<uint32_t> trie;
+        trie.insert(ranges, values);
+
+        ofxNet::IPv4AddressRangeTable<uint32_t> table;
+        table.build(ranges, values);
+
+        std::size_t matches = 0;
+        uint64_t start = ofGetElapsedTimeMicros();
+
+        for (auto address: addressesIPv4)
+            matches += trie.find(ofxNet::CompactIPAddress(&address, 4)) != nullptr;
+
+        addResult("IPv4 IPAddressRangeTable::find", count, matches, ofGetElapsedTimeMicros() - start);
+
+        matches = 0;
+        start = ofGetElapsedTimeMicros();
+
+        for (auto address: addressesIPv4)
+            matches += table.findIndex(address) != ofxNet::IPv4AddressRangeTable<uint32_t>::NONE;
+
+        addResult("IPv4 DIR-24-8 findIndex", count, matches, ofGetElapsedTimeMicros() - start);
+
+        std::vector<uint32_t> indices(count);
+
+        start = ofGetElapsedTimeMicros();
+        matches = table.find(addressesIPv4.data(), count, indices.data());
+        addResult("IPv4 DIR-24-8 batch find", count, matches, ofGetElapsedTimeMicros() - start);
+
+        results << "DIR-24-8 tables use " << table.memoryUsage() / (1024 * 1024) << " MiB for " << rangeCount << " ranges." << std::endl;
+    }
+
+    std::cout << results.str();
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofDrawBitmapString(results.str(), 14, 14);
+}
+
+
+void ofApp::addResult(const std::string& name,
+                      std::size_t count,
+                      std::size_t matches,
+                      uint64_t micros)
+{
+    double millionsPerSecond = micros > 0 ? double(count) / micros : 0;
+
+    results << std::setw(36) << std::left << name;
+    results << std::setw(10) << std::right << micros << " us ";
+    results << std::setw(10) << std::fixed << std::setprecision(1) << millionsPerSecond << " M addresses/s";
+    results << " (" << matches << " matches)";
+    results << std::endl;
+}
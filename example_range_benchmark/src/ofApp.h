@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2014 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxNetworkUtils.h"
+
+
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Record a throughput measurement.
+    /// \param name The name of the measured path.
+    /// \param count The number of addresses processed.
+    /// \param matches The number of matching addresses.
+    /// \param micros The elapsed time in microseconds.
+    void addResult(const std::string& name,
+                   std::size_t count,
+                   std::size_t matches,
+                   uint64_t micros);
+
+    std::stringstream results;
+
+};
@@ -0,0 +1,356 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Poco/Net/HostEntry.h"
+#include "Poco/Net/IPAddress.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief Resolve host names and addresses without blocking the caller.
+///
+/// Lookups run on a fixed pool of worker threads. Each request returns a
+/// Request handle whose future is fulfilled when the lookup finishes, times
+/// out or is cancelled. An optional callback is called at the same time.
+///
+/// Concurrent requests for the same query share one in-flight lookup. Each
+/// request keeps its own timeout and can be cancelled without affecting the
+/// others.
+///
+/// System resolver calls cannot be interrupted. A timed out or cancelled
+/// request completes immediately, but its lookup keeps a worker busy until
+/// the backend returns.
+///
+/// Lookups are performed by a Backend function. The default backend calls
+/// Poco::Net::DNS. A custom backend can be given in Settings, for example to
+/// test without a network.
+class AsyncHostResolver
+{
+public:
+    /// \brief A typedef for Poco::Net::HostEntry.
+    typedef Poco::Net::HostEntry HostEntry;
+
+    /// \brief The kind of lookup to perform.
+    enum class QueryType
+    {
+        /// \brief Look up a host name, as Poco::Net::DNS::hostByName().
+        HOST_BY_NAME,
+        /// \brief Look up an address, as Poco::Net::DNS::hostByAddress().
+        HOST_BY_ADDRESS,
+        /// \brief Look up a name or address, as Poco::Net::DNS::resolve().
+        RESOLVE,
+        /// \brief Look up this host, as Poco::Net::DNS::thisHost().
+        THIS_HOST
+    };
+
+    /// \brief A lookup request.
+    struct Query
+    {
+        /// \brief The kind of lookup.
+        QueryType type;
+
+        /// \brief The host name or address string. Empty for THIS_HOST.
+        std::string host;
+
+        /// \returns a key that is equal for equal queries. Used to share
+        ///          in-flight lookups and by HostEntryCache.
+        std::string key() const;
+    };
+
+    /// \brief The outcome of a request.
+    enum class Status
+    {
+        /// \brief The lookup succeeded.
+        SUCCESS,
+        /// \brief The host was not found.
+        NOT_FOUND,
+        /// \brief The host was found but has no addresses.
+        NO_ADDRESS_FOUND,
+        /// \brief The resolver reported an error.
+        DNS_ERROR,
+        /// \brief The request timed out.
+        TIMEOUT,
+        /// \brief The request was cancelled.
+        CANCELLED,
+        /// \brief The request queue was full.
+        REJECTED,
+        /// \brief Any other error.
+        UNKNOWN_ERROR
+    };
+
+    /// \brief The result of a request.
+    struct Result
+    {
+        /// \brief The outcome.
+        Status status;
+
+        /// \brief The host entry. Empty unless status is SUCCESS.
+        HostEntry hostEntry;
+
+        /// \brief A description of the error, if any.
+        std::string message;
+
+        /// \returns true iff status is SUCCESS.
+        bool success() const;
+    };
+
+    /// \brief A function that performs a blocking lookup.
+    ///
+    /// Backends report failures by throwing Poco::Net::HostNotFoundException,
+    /// Poco::Net::NoAddressFoundException, Poco::Net::DNSException or any
+    /// other exception. Backends are called concurrently from the worker
+    /// threads.
+    typedef std::function<HostEntry(const Query&)> Backend;
+
+    /// \brief A function called when a request completes.
+    ///
+    /// Callbacks are called from a worker thread or the timeout thread, and
+    /// must not block.
+    typedef std::function<void(const Result&)> Callback;
+
+    /// \brief A handle to a submitted request.
+    class Request
+    {
+    public:
+        /// \brief Create an empty handle.
+        Request();
+
+        /// \returns a future fulfilled when the request completes.
+        std::shared_future<Result> future() const;
+
+        /// \brief Cancel the request.
+        ///
+        /// The future is fulfilled with Status::CANCELLED. If no other request
+        /// shares the lookup and it has not started, the lookup is skipped.
+        ///
+        /// \returns true iff the request had not already completed.
+        bool cancel();
+
+        /// \returns true iff the request has completed.
+        bool isDone() const;
+
+        /// \returns true iff this handle refers to a request.
+        bool isValid() const;
+
+    private:
+        friend class AsyncHostResolver;
+
+        struct Waiter;
+
+        explicit Request(std::shared_ptr<Waiter> waiter);
+
+        std::shared_ptr<Waiter> _waiter;
+
+    };
+
+    enum
+    {
+        /// \brief The default number of concurrent lookups for a batch.
+        DEFAULT_MAXIMUM_IN_FLIGHT = 16
+    };
+
+    /// \brief Resolver settings.
+    struct Settings
+    {
+        /// \brief The number of worker threads.
+        std::size_t threadCount = 4;
+
+        /// \brief The maximum number of lookups waiting for a worker.
+        ///
+        /// Requests that would start a new lookup beyond this limit complete
+        /// immediately with Status::REJECTED.
+        std::size_t maximumQueueSize = 1024;
+
+        /// \brief The timeout used when a request does not give one.
+        std::chrono::milliseconds defaultTimeout = std::chrono::milliseconds(5000);
+
+        /// \brief The lookup function. If empty, systemBackend() is used.
+        Backend backend;
+    };
+
+    /// \brief Create a resolver with default settings.
+    AsyncHostResolver();
+
+    /// \brief Create a resolver.
+    /// \param settings The resolver settings.
+    explicit AsyncHostResolver(const Settings& settings);
+
+    /// \brief Cancel all queued requests and stop the workers.
+    ///
+    /// Waits for lookups that are already running to return.
+    ~AsyncHostResolver();
+
+    AsyncHostResolver(const AsyncHostResolver&) = delete;
+    AsyncHostResolver& operator = (const AsyncHostResolver&) = delete;
+
+    /// \brief Look up a host name.
+    /// \param hostname The host name.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    Request getHostByName(const std::string& hostname,
+                          Callback callback = nullptr);
+
+    /// \brief Look up an address.
+    /// \param address The address.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    Request getHostByAddress(const Poco::Net::IPAddress& address,
+                             Callback callback = nullptr);
+
+    /// \brief Look up a host name or address.
+    /// \param address The host name or address string.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    Request getHost(const std::string& address,
+                    Callback callback = nullptr);
+
+    /// \brief Look up this host.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    Request getThisHost(Callback callback = nullptr);
+
+    /// \brief Look up a batch of addresses and wait for all of them.
+    ///
+    /// Duplicate addresses are looked up once. At most maximumInFlight
+    /// lookups are outstanding at a time, so a large batch neither fills the
+    /// queue nor starves other callers.
+    ///
+    /// \param addresses The addresses.
+    /// \param count The number of addresses.
+    /// \param maximumInFlight The maximum number of concurrent lookups.
+    /// \param timeout The timeout of each lookup.
+    /// \returns one result per address, in input order.
+    std::vector<Result> getHostsByAddress(const Poco::Net::IPAddress* addresses,
+                                          std::size_t count,
+                                          std::size_t maximumInFlight,
+                                          std::chrono::milliseconds timeout);
+
+    /// \brief Look up a batch of addresses with the default timeout.
+    /// \param addresses The addresses.
+    /// \param maximumInFlight The maximum number of concurrent lookups.
+    /// \returns one result per address, in input order.
+    std::vector<Result> getHostsByAddress(const std::vector<Poco::Net::IPAddress>& addresses,
+                                          std::size_t maximumInFlight = DEFAULT_MAXIMUM_IN_FLIGHT);
+
+    /// \brief Resolve a batch of queries and wait for all of them.
+    ///
+    /// Must not be called from a callback, because the worker it runs on
+    /// may be needed to complete the batch.
+    ///
+    /// \param queries The queries.
+    /// \param maximumInFlight The maximum number of concurrent lookups. It is
+    ///        also capped at the queue size so a batch is never rejected.
+    /// \param timeout The timeout of each lookup.
+    /// \returns one result per query, in input order.
+    std::vector<Result> resolveAll(const std::vector<Query>& queries,
+                                   std::size_t maximumInFlight,
+                                   std::chrono::milliseconds timeout);
+
+    /// \brief Submit a query.
+    /// \param query The query.
+    /// \param timeout The time to wait before completing with Status::TIMEOUT.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    Request submit(const Query& query,
+                   std::chrono::milliseconds timeout,
+                   Callback callback = nullptr);
+
+    /// \brief Submit a query with the default timeout.
+    /// \param query The query.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    Request submit(const Query& query, Callback callback = nullptr);
+
+    /// \returns the number of lookups queued or running.
+    std::size_t inFlight() const;
+
+    /// \returns the resolver settings.
+    const Settings& settings() const;
+
+    /// \returns a backend that calls Poco::Net::DNS.
+    static Backend systemBackend();
+
+    /// \brief Call a backend and convert its outcome to a Result.
+    /// \param backend The backend.
+    /// \param query The query.
+    /// \returns the result.
+    static Result resolve(const Backend& backend, const Query& query);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Lookup;
+
+    /// \brief The worker thread function.
+    void work();
+
+    /// \brief The timeout thread function.
+    void expire();
+
+    /// \brief Remove queued lookups that no request is waiting for.
+    ///
+    /// Must be called with _mutex held.
+    void pruneQueue();
+
+    /// \brief Remove the deadline of a completed request, if it has one.
+    void removeDeadline(Request::Waiter& waiter);
+
+    /// \brief The settings.
+    Settings _settings;
+
+    /// \brief Guards all members below.
+    mutable std::mutex _mutex;
+
+    /// \brief Signals queued lookups to the workers.
+    std::condition_variable _workCondition;
+
+    /// \brief Signals new deadlines to the timeout thread.
+    std::condition_variable _timeoutCondition;
+
+    /// \brief Lookups waiting for a worker.
+    std::deque<std::shared_ptr<Lookup>> _queue;
+
+    /// \brief Queued and running lookups by query key.
+    std::map<std::string, std::shared_ptr<Lookup>> _inFlight;
+
+    typedef std::multimap<Clock::time_point, std::weak_ptr<Request::Waiter>> Deadlines;
+
+    /// \brief The deadlines of pending requests. Entries are removed when
+    ///        their request completes.
+    Deadlines _deadlines;
+
+    /// \brief True when the resolver is shutting down.
+    bool _stopping;
+
+    /// \brief The worker threads.
+    std::vector<std::thread> _workers;
+
+    /// \brief The timeout thread.
+    std::thread _timeoutThread;
+
+};
+
+
+} } // namespace ofx::Net
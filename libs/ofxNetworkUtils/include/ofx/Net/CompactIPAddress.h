@@ -0,0 +1,327 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include "Poco/Net/IPAddress.h"
+#include "ofx/Net/IPAddressBits.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A trivially-copyable IPv4 or IPv6 address.
+///
+/// Unlike Poco::Net::IPAddress, a CompactIPAddress has no heap allocated
+/// implementation. It stores 16 address bytes in network byte order and a
+/// family tag. IPv4 addresses use the first four bytes and the remaining
+/// bytes are always zero.
+///
+/// IPv6 scope ids are not stored.
+class CompactIPAddress
+{
+public:
+    /// \brief The address family tag.
+    enum Family: uint8_t
+    {
+        /// \brief An IPv4 address.
+        IPv4 = 4,
+        /// \brief An IPv6 address.
+        IPv6 = 6
+    };
+
+    /// \brief Create a wildcard (zero) IPv4 address.
+    CompactIPAddress();
+
+    /// \brief Create a wildcard (zero) address for the given family.
+    /// \param family The address family.
+    explicit CompactIPAddress(Family family);
+
+    /// \brief Create an address from raw bytes in network byte order.
+    /// \param bytes The address bytes.
+    /// \param length The number of bytes, 4 for IPv4 and 16 for IPv6.
+    CompactIPAddress(const void* bytes, std::size_t length);
+
+    /// \brief Create an address from left-aligned address bits.
+    /// \param bits The address bits.
+    /// \param family The address family.
+    CompactIPAddress(const IPAddressBits& bits, Family family);
+
+    /// \brief Create an address from a Poco::Net::IPAddress.
+    /// \param address The address to copy.
+    explicit CompactIPAddress(const Poco::Net::IPAddress& address);
+
+    /// \returns the address family tag.
+    Family family() const;
+
+    /// \returns true iff this is an IPv4 address.
+    bool isIPv4() const;
+
+    /// \returns true iff this is an IPv6 address.
+    bool isIPv6() const;
+
+    /// \returns the number of significant bytes (4 or 16).
+    std::size_t length() const;
+
+    /// \returns the number of significant bits (32 or 128).
+    unsigned bitLength() const;
+
+    /// \returns a pointer to the address bytes in network byte order.
+    const uint8_t* bytes() const;
+
+    /// \returns the left-aligned address bits.
+    IPAddressBits bits() const;
+
+    /// \brief Get a single bit of the address.
+    /// \param index The bit index, where 0 is the most significant bit.
+    /// \returns the bit value.
+    bool bit(unsigned index) const;
+
+    /// \brief Count the leading bits shared with another address.
+    /// \param address The address to compare with.
+    /// \returns the common prefix length or 0 if the families differ.
+    unsigned commonPrefixLength(const CompactIPAddress& address) const;
+
+    /// \brief Test to see if the leading bits match another address.
+    /// \param address The address to compare with.
+    /// \param prefix The number of leading bits to compare.
+    /// \returns true iff the families and the first prefix bits are equal.
+    bool matches(const CompactIPAddress& address, unsigned prefix) const;
+
+    /// \brief Apply a network mask.
+    /// \param prefix The mask prefix length.
+    /// \returns a copy of this address with all bits after prefix cleared.
+    CompactIPAddress masked(unsigned prefix) const;
+
+    /// \brief Apply a wildcard mask.
+    /// \param prefix The mask prefix length.
+    /// \returns a copy of this address with all bits after prefix set.
+    CompactIPAddress filled(unsigned prefix) const;
+
+    /// \returns a Poco::Net::IPAddress copy of this address.
+    Poco::Net::IPAddress toIPAddress() const;
+
+    /// \returns the string representation of this address.
+    std::string toString() const;
+
+    bool operator == (const CompactIPAddress& address) const;
+    bool operator != (const CompactIPAddress& address) const;
+
+    /// \brief Order by family, then by address bytes.
+    bool operator < (const CompactIPAddress& address) const;
+
+    /// \returns a well-mixed hash of the family and address bytes.
+    std::size_t hash() const;
+
+    /// \brief Create a network mask.
+    /// \param prefix The mask prefix length, clamped to the family maximum.
+    /// \param family The address family.
+    /// \returns the network mask.
+    static CompactIPAddress mask(unsigned prefix, Family family);
+
+    /// \brief Get the maximum prefix length for the given family.
+    /// \param family The address family.
+    /// \returns 32 for IPv4 and 128 for IPv6.
+    static unsigned maximumPrefix(Family family);
+
+private:
+    /// \brief The address bytes in network byte order.
+    uint8_t _bytes[16];
+
+    /// \brief The address family.
+    uint8_t _family;
+
+};
+
+
+inline CompactIPAddress::CompactIPAddress(): CompactIPAddress(IPv4)
+{
+}
+
+
+inline CompactIPAddress::CompactIPAddress(Family family): _family(family)
+{
+    std::memset(_bytes, 0, sizeof(_bytes));
+}
+
+
+inline CompactIPAddress::CompactIPAddress(const void* bytes,
+                                          std::size_t length):
+    CompactIPAddress(length == 16 ? IPv6 : IPv4)
+{
+    std::memcpy(_bytes, bytes, length == 16 ? 16 : 4);
+}
+
+
+inline CompactIPAddress::CompactIPAddress(const IPAddressBits& bits,
+                                          Family family):
+    CompactIPAddress(family)
+{
+    bits.store(_bytes, length());
+}
+
+
+inline CompactIPAddress::CompactIPAddress(const Poco::Net::IPAddress& address):
+    CompactIPAddress(address.addr(), address.length())
+{
+}
+
+
+inline CompactIPAddress::Family CompactIPAddress::family() const
+{
+    return static_cast<Family>(_family);
+}
+
+
+inline bool CompactIPAddress::isIPv4() const
+{
+    return _family == IPv4;
+}
+
+
+inline bool CompactIPAddress::isIPv6() const
+{
+    return _family == IPv6;
+}
+
+
+inline std::size_t CompactIPAddress::length() const
+{
+    return isIPv6() ? 16 : 4;
+}
+
+
+inline unsigned CompactIPAddress::bitLength() const
+{
+    return maximumPrefix(family());
+}
+
+
+inline const uint8_t* CompactIPAddress::bytes() const
+{
+    return _bytes;
+}
+
+
+inline IPAddressBits CompactIPAddress::bits() const
+{
+    return IPAddressBits::load(_bytes, length());
+}
+
+
+inline bool CompactIPAddress::bit(unsigned index) const
+{
+    return (_bytes[index / 8] >> (7 - (index % 8))) & 1;
+}
+
+
+inline unsigned CompactIPAddress::commonPrefixLength(const CompactIPAddress& address) const
+{
+    if (_family != address._family)
+        return 0;
+
+    const unsigned result = (bits() ^ address.bits()).countLeadingZeros();
+    return result < bitLength() ? result : bitLength();
+}
+
+
+inline bool CompactIPAddress::matches(const CompactIPAddress& address,
+                                      unsigned prefix) const
+{
+    return _family == address._family
+        && IPAddressBits::matches(bits(), address.bits(), prefix);
+}
+
+
+inline CompactIPAddress CompactIPAddress::masked(unsigned prefix) const
+{
+    return CompactIPAddress(bits() & IPAddressBits::mask(prefix), family());
+}
+
+
+inline CompactIPAddress CompactIPAddress::filled(unsigned prefix) const
+{
+    return CompactIPAddress(bits() | ~IPAddressBits::mask(prefix), family());
+}
+
+
+inline Poco::Net::IPAddress CompactIPAddress::toIPAddress() const
+{
+    return Poco::Net::IPAddress(_bytes, static_cast<poco_socklen_t>(length()));
+}
+
+
+inline std::string CompactIPAddress::toString() const
+{
+    return toIPAddress().toString();
+}
+
+
+inline bool CompactIPAddress::operator == (const CompactIPAddress& address) const
+{
+    return _family == address._family
+        && std::memcmp(_bytes, address._bytes, sizeof(_bytes)) == 0;
+}
+
+
+inline bool CompactIPAddress::operator != (const CompactIPAddress& address) const
+{
+    return !(*this == address);
+}
+
+
+inline bool CompactIPAddress::operator < (const CompactIPAddress& address) const
+{
+    if (_family != address._family)
+        return _family < address._family;
+
+    return std::memcmp(_bytes, address._bytes, sizeof(_bytes)) < 0;
+}
+
+
+inline std::size_t CompactIPAddress::hash() const
+{
+    return bits().hash(_family);
+}
+
+
+inline CompactIPAddress CompactIPAddress::mask(unsigned prefix, Family family)
+{
+    const unsigned maximum = maximumPrefix(family);
+    return CompactIPAddress(IPAddressBits::mask(prefix < maximum ? prefix : maximum), family);
+}
+
+
+inline unsigned CompactIPAddress::maximumPrefix(Family family)
+{
+    return family == IPv6 ? 128 : 32;
+}
+
+
+} } // namespace ofx::Net
+
+
+namespace std {
+
+
+template<>
+struct hash<ofx::Net::CompactIPAddress>
+{
+    std::size_t operator()(const ofx::Net::CompactIPAddress& address) const
+    {
+        return address.hash();
+    }
+};
+
+
+} // namespace std
@@ -0,0 +1,228 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/Net/CompactIPAddress.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A trivially-copyable range of IP addresses.
+///
+/// A CompactIPAddressRange is an address and a prefix length packed into 18
+/// bytes. The mask, subnet, wildcard mask and host limits are derived from
+/// those two values on demand.
+class CompactIPAddressRange
+{
+public:
+    /// \brief Create a wildcard (zero) IPv4 address with /32.
+    CompactIPAddressRange();
+
+    /// \brief Create a range from one address.
+    /// \param address The single address representing the range.
+    explicit CompactIPAddressRange(const CompactIPAddress& address);
+
+    /// \brief Create a range from an address and a prefix.
+    /// \param address The address.
+    /// \param prefix The mask prefix length, clamped to the family maximum.
+    CompactIPAddressRange(const CompactIPAddress& address, unsigned prefix);
+
+    /// \returns the address component of the range.
+    const CompactIPAddress& address() const;
+
+    /// \returns the mask prefix length.
+    unsigned prefix() const;
+
+    /// \returns the address family tag.
+    CompactIPAddress::Family family() const;
+
+    /// \returns the network mask for the range.
+    CompactIPAddress mask() const;
+
+    /// \returns the wildcard mask for the range.
+    CompactIPAddress wildcardMask() const;
+
+    /// \returns the subnet of the range.
+    CompactIPAddress subnet() const;
+
+    /// \returns the smallest address in the range.
+    CompactIPAddress hostMin() const;
+
+    /// \returns the largest address in the range.
+    CompactIPAddress hostMax() const;
+
+    /// \brief Test to see if this range contains an address.
+    /// \param address The address to test.
+    /// \returns true iff the given address is contained within this range.
+    bool contains(const CompactIPAddress& address) const;
+
+    /// \brief Test to see if this range contains another.
+    /// \param range The range to test.
+    /// \returns true iff the given range is fully contained within this range.
+    bool contains(const CompactIPAddressRange& range) const;
+
+    bool operator == (const CompactIPAddressRange& range) const;
+    bool operator != (const CompactIPAddressRange& range) const;
+
+    /// \brief Order by family, then by subnet, then by prefix length.
+    ///
+    /// Ranges that differ only in their host bits are ordered by address, so
+    /// this is a strict weak ordering consistent with operator==.
+    bool operator < (const CompactIPAddressRange& range) const;
+
+    /// \returns a well-mixed hash of the address and prefix length.
+    std::size_t hash() const;
+
+private:
+    /// \brief The address.
+    CompactIPAddress _address;
+
+    /// \brief The mask prefix length.
+    uint8_t _prefix;
+
+};
+
+
+inline CompactIPAddressRange::CompactIPAddressRange():
+    CompactIPAddressRange(CompactIPAddress())
+{
+}
+
+
+inline CompactIPAddressRange::CompactIPAddressRange(const CompactIPAddress& address):
+    CompactIPAddressRange(address, address.bitLength())
+{
+}
+
+
+inline CompactIPAddressRange::CompactIPAddressRange(const CompactIPAddress& address,
+                                                    unsigned prefix):
+    _address(address),
+    _prefix(static_cast<uint8_t>(prefix < address.bitLength() ? prefix : address.bitLength()))
+{
+}
+
+
+inline const CompactIPAddress& CompactIPAddressRange::address() const
+{
+    return _address;
+}
+
+
+inline unsigned CompactIPAddressRange::prefix() const
+{
+    return _prefix;
+}
+
+
+inline CompactIPAddress::Family CompactIPAddressRange::family() const
+{
+    return _address.family();
+}
+
+
+inline CompactIPAddress CompactIPAddressRange::mask() const
+{
+    return CompactIPAddress::mask(_prefix, family());
+}
+
+
+inline CompactIPAddress CompactIPAddressRange::wildcardMask() const
+{
+    return CompactIPAddress(family()).filled(_prefix);
+}
+
+
+inline CompactIPAddress CompactIPAddressRange::subnet() const
+{
+    return _address.masked(_prefix);
+}
+
+
+inline CompactIPAddress CompactIPAddressRange::hostMin() const
+{
+    return subnet();
+}
+
+
+inline CompactIPAddress CompactIPAddressRange::hostMax() const
+{
+    return _address.filled(_prefix);
+}
+
+
+inline bool CompactIPAddressRange::contains(const CompactIPAddress& address) const
+{
+    return _address.matches(address, _prefix);
+}
+
+
+inline bool CompactIPAddressRange::contains(const CompactIPAddressRange& range) const
+{
+    return _prefix <= range._prefix && _address.matches(range._address, _prefix);
+}
+
+
+inline bool CompactIPAddressRange::operator == (const CompactIPAddressRange& range) const
+{
+    return _prefix == range._prefix && _address == range._address;
+}
+
+
+inline bool CompactIPAddressRange::operator != (const CompactIPAddressRange& range) const
+{
+    return !(*this == range);
+}
+
+
+inline bool CompactIPAddressRange::operator < (const CompactIPAddressRange& range) const
+{
+    if (family() != range.family())
+        return family() < range.family();
+
+    const IPAddressBits bits = _address.bits();
+    const IPAddressBits otherBits = range._address.bits();
+    const IPAddressBits subnet = bits & IPAddressBits::mask(_prefix);
+    const IPAddressBits otherSubnet = otherBits & IPAddressBits::mask(range._prefix);
+
+    if (subnet != otherSubnet)
+        return subnet < otherSubnet;
+
+    if (_prefix != range._prefix)
+        return _prefix < range._prefix;
+
+    return bits < otherBits;
+}
+
+
+inline std::size_t CompactIPAddressRange::hash() const
+{
+    return _address.bits().hash((uint64_t(_prefix) << 8) | _address.family());
+}
+
+
+} } // namespace ofx::Net
+
+
+namespace std {
+
+
+template<>
+struct hash<ofx::Net::CompactIPAddressRange>
+{
+    std::size_t operator()(const ofx::Net::CompactIPAddressRange& range) const
+    {
+        return range.hash();
+    }
+};
+
+
+} // namespace std
@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "ofx/Net/AsyncHostResolver.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A thread-safe cache of DNS lookup results.
+///
+/// Results are stored in a fixed number of shards. Each shard has its own
+/// lock and least-recently-used eviction order. This keeps contention low
+/// when many threads resolve the same names.
+///
+/// Successful results are kept for positiveTimeToLive. Results that failed
+/// with Status::NOT_FOUND or Status::NO_ADDRESS_FOUND are kept for
+/// negativeTimeToLive. Other failures, such as timeouts, are not cached.
+/// The system resolver does not report record TTLs, so TTLs come from the
+/// settings or are given to insert() directly.
+///
+/// If a resolver is set, a hot entry that is close to expiring is refreshed
+/// in the background. Callers keep getting the cached value until the new
+/// one arrives, so popular names never miss.
+class HostEntryCache
+{
+public:
+    typedef AsyncHostResolver::Query Query;
+    typedef AsyncHostResolver::Result Result;
+    typedef std::chrono::steady_clock Clock;
+
+    /// \brief Cache settings.
+    struct Settings
+    {
+        /// \brief The maximum number of cached results across all shards.
+        std::size_t capacity = 4096;
+
+        /// \brief The number of independently locked shards.
+        std::size_t shardCount = 16;
+
+        /// \brief How long successful results are kept.
+        std::chrono::milliseconds positiveTimeToLive = std::chrono::milliseconds(60000);
+
+        /// \brief How long NOT_FOUND and NO_ADDRESS_FOUND results are kept.
+        std::chrono::milliseconds negativeTimeToLive = std::chrono::milliseconds(5000);
+
+        /// \brief The fraction of the TTL after which a hot entry is refreshed.
+        float refreshAhead = 0.75f;
+
+        /// \brief The number of hits that makes an entry hot.
+        uint32_t refreshAheadHits = 2;
+
+        /// \brief The resolver used for refresh-ahead. If nullptr, entries
+        ///        are not refreshed and simply expire.
+        std::shared_ptr<AsyncHostResolver> resolver;
+
+        /// \brief The function used for lookups on a miss. If empty,
+        ///        AsyncHostResolver::systemBackend() is used.
+        AsyncHostResolver::Backend backend;
+    };
+
+    /// \brief Cache counters.
+    struct Statistics
+    {
+        /// \brief Lookups answered from the cache, including negative hits.
+        uint64_t hits = 0;
+
+        /// \brief Lookups answered with a cached NOT_FOUND or NO_ADDRESS_FOUND.
+        uint64_t negativeHits = 0;
+
+        /// \brief Lookups that were not in the cache or had expired.
+        uint64_t misses = 0;
+
+        /// \brief Entries removed to make room for new ones.
+        uint64_t evictions = 0;
+
+        /// \brief Entries removed because their TTL passed.
+        uint64_t expirations = 0;
+
+        /// \brief Background refreshes started.
+        uint64_t refreshes = 0;
+
+        /// \brief The number of cached entries.
+        std::size_t size = 0;
+    };
+
+    /// \brief Create a cache with default settings.
+    HostEntryCache();
+
+    /// \brief Create a cache.
+    /// \param settings The cache settings.
+    explicit HostEntryCache(const Settings& settings);
+
+    /// \brief Destroy the cache.
+    ///
+    /// Background refreshes that complete later are discarded.
+    ~HostEntryCache();
+
+    HostEntryCache(const HostEntryCache&) = delete;
+    HostEntryCache& operator = (const HostEntryCache&) = delete;
+
+    /// \brief Resolve a query through the cache.
+    ///
+    /// On a miss the backend is called on the calling thread and the result
+    /// is cached if it is cacheable.
+    ///
+    /// \param query The query.
+    /// \returns the cached or newly resolved result.
+    Result resolve(const Query& query);
+
+    /// \brief Resolve a query through the cache with a given backend.
+    /// \param query The query.
+    /// \param backend The backend called on a miss.
+    /// \returns the cached or newly resolved result.
+    Result resolve(const Query& query, const AsyncHostResolver::Backend& backend);
+
+    /// \brief Look up a cached result.
+    /// \param query The query.
+    /// \param result The cached result, unchanged on a miss.
+    /// \returns true iff a live entry was found.
+    bool find(const Query& query, Result& result);
+
+    /// \brief Cache a result using the TTL for its status.
+    /// \param query The query.
+    /// \param result The result. Results that are not cacheable are ignored.
+    void insert(const Query& query, const Result& result);
+
+    /// \brief Cache a result with an explicit TTL.
+    /// \param query The query.
+    /// \param result The result.
+    /// \param timeToLive How long to keep the result.
+    void insert(const Query& query,
+                const Result& result,
+                std::chrono::milliseconds timeToLive);
+
+    /// \brief Remove a cached result.
+    /// \param query The query.
+    void erase(const Query& query);
+
+    /// \brief Remove all cached results.
+    void clear();
+
+    /// \returns the current counters.
+    Statistics statistics() const;
+
+    /// \brief Reset all counters to zero.
+    void resetStatistics();
+
+    /// \returns the cache settings.
+    const Settings& settings() const;
+
+    /// \param status The result status.
+    /// \returns true iff results with this status are cached.
+    static bool isCacheable(AsyncHostResolver::Status status);
+
+private:
+    struct State;
+
+    /// \brief Start a background refresh of an entry.
+    void refresh(const Query& query);
+
+    /// \brief The shared state, also referenced by pending refreshes.
+    std::shared_ptr<State> _state;
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Poco/Net/HostEntry.h"
+#include "Poco/Net/IPAddress.h"
+#include "ofx/Net/AsyncHostResolver.h"
+#include "ofx/Net/CompactIPAddress.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief An in-memory host table in the /etc/hosts format.
+///
+/// Each line holds an address, a canonical host name and optional aliases.
+/// Text after a # is a comment. Names are matched case-insensitively.
+///
+/// Lookups are answered from hash indices without calling the system
+/// resolver. Entries are built the way the system resolver builds them:
+///
+/// - A name or alias refers to the host it first appeared with. A later
+///   line whose canonical name is already known adds its address to that
+///   host, so a host may have both IPv4 and IPv6 addresses.
+/// - An address refers to the host of the first line with that address.
+/// - Aliases are not reported, as with Poco::Net::DNS.
+///
+/// A table is not synchronized. Fill it first and share it read-only, for
+/// example through backend().
+class HostsTable
+{
+public:
+    /// \brief A typedef for Poco::Net::HostEntry.
+    typedef Poco::Net::HostEntry HostEntry;
+
+    /// \brief Create an empty table.
+    HostsTable();
+
+    /// \brief Load a hosts file, adding to the current contents.
+    ///
+    /// The path is resolved with ofToDataPath(). Invalid lines are skipped.
+    ///
+    /// \param path The file path.
+    /// \returns true iff the file could be read.
+    bool load(const std::string& path = DEFAULT_PATH);
+
+    /// \brief Parse hosts file text, adding to the current contents.
+    /// \param text The file contents.
+    /// \returns the number of lines that were added.
+    std::size_t parse(const std::string& text);
+
+    /// \brief Add a host.
+    /// \param address The host address.
+    /// \param name The canonical host name.
+    /// \param aliases Other names for the host.
+    void add(const Poco::Net::IPAddress& address,
+             const std::string& name,
+             const std::vector<std::string>& aliases = std::vector<std::string>());
+
+    /// \brief Look up a host name or alias.
+    /// \param name The name.
+    /// \param hostEntry The entry, unchanged if the name is not found.
+    /// \returns true iff the name was found.
+    bool findByName(const std::string& name, HostEntry& hostEntry) const;
+
+    /// \brief Look up an address.
+    /// \param address The address.
+    /// \param hostEntry The entry, unchanged if the address is not found.
+    /// \returns true iff the address was found.
+    bool findByAddress(const Poco::Net::IPAddress& address, HostEntry& hostEntry) const;
+
+    /// \returns the number of distinct names, including aliases.
+    std::size_t size() const;
+
+    /// \returns true iff the table is empty.
+    bool empty() const;
+
+    /// \brief Remove all hosts.
+    void clear();
+
+    /// \brief Create a resolver backend that answers from a table.
+    ///
+    /// HOST_BY_NAME, HOST_BY_ADDRESS and RESOLVE queries are answered from
+    /// the table. THIS_HOST queries and names that are not in the table go
+    /// to the fallback. Without a fallback, misses throw
+    /// Poco::Net::HostNotFoundException.
+    ///
+    /// \param table The table. It must not be modified while in use.
+    /// \param fallback The backend for queries the table cannot answer.
+    /// \returns the backend.
+    static AsyncHostResolver::Backend backend(std::shared_ptr<const HostsTable> table,
+                                              AsyncHostResolver::Backend fallback = AsyncHostResolver::systemBackend());
+
+    /// \brief The path of the system hosts file.
+    static const std::string DEFAULT_PATH;
+
+private:
+    /// \brief A canonical name and its addresses.
+    struct Host
+    {
+        std::string name;
+        std::vector<Poco::Net::IPAddress> addresses;
+        HostEntry hostEntry;
+    };
+
+    /// \brief Rebuild the cached entry of a host.
+    static void update(Host& host);
+
+    /// \returns the lowercase form of a name.
+    static std::string toKey(const std::string& name);
+
+    /// \brief Hosts in the order they were first listed.
+    std::vector<Host> _hosts;
+
+    /// \brief Host indices by lowercase name or alias.
+    std::unordered_map<std::string, std::size_t> _names;
+
+    /// \brief Host indices by address.
+    std::unordered_map<CompactIPAddress, std::size_t> _addresses;
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,346 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief 128 address bits held as a pair of 64-bit words.
+///
+/// Addresses are left-aligned, so bit 0 is the most significant bit of
+/// high and an IPv4 address occupies the top 32 bits of high. This lets
+/// IPv4 and IPv6 share the same prefix math. All operations are branch-light
+/// and never throw or allocate.
+///
+/// The arithmetic and shift operators treat the value as an unsigned 128-bit
+/// integer and wrap on overflow. Shifting an address right by
+/// (128 - bit length) gives its numeric value.
+struct IPAddressBits
+{
+    /// \brief The most significant 64 bits.
+    uint64_t high;
+
+    /// \brief The least significant 64 bits.
+    uint64_t low;
+
+    /// \brief Load address bytes in network byte order.
+    /// \param bytes The address bytes.
+    /// \param length The number of bytes, 4 or 16.
+    /// \returns the left-aligned address bits.
+    static IPAddressBits load(const uint8_t* bytes, std::size_t length);
+
+    /// \brief Store address bytes in network byte order.
+    /// \param bytes The destination, at least length bytes.
+    /// \param length The number of bytes, 4 or 16.
+    void store(uint8_t* bytes, std::size_t length) const;
+
+    /// \brief Create a left-aligned network mask.
+    /// \param prefix The number of leading one bits, from 0 to 128.
+    /// \returns the mask.
+    static IPAddressBits mask(unsigned prefix);
+
+    /// \brief Compare the leading bits of two values.
+    /// \param a The first value.
+    /// \param b The second value.
+    /// \param prefix The number of leading bits to compare.
+    /// \returns true iff the first prefix bits of a and b are equal.
+    static bool matches(const IPAddressBits& a,
+                        const IPAddressBits& b,
+                        unsigned prefix);
+
+    /// \returns the number of leading zero bits, or 128 if all bits are zero.
+    unsigned countLeadingZeros() const;
+
+    /// \returns the number of trailing zero bits, or 128 if all bits are zero.
+    unsigned countTrailingZeros() const;
+
+    /// \param count The number of bits to shift, from 0 to 128.
+    /// \returns the value shifted towards the most significant bit.
+    IPAddressBits shiftLeft(unsigned count) const;
+
+    /// \param count The number of bits to shift, from 0 to 128.
+    /// \returns the value shifted towards the least significant bit.
+    IPAddressBits shiftRight(unsigned count) const;
+
+    /// \param index The bit index, where 0 is the most significant bit.
+    /// \returns the bit value.
+    bool bit(unsigned index) const;
+
+    /// \returns true iff all bits are zero.
+    bool isZero() const;
+
+    IPAddressBits operator & (const IPAddressBits& other) const;
+    IPAddressBits operator | (const IPAddressBits& other) const;
+    IPAddressBits operator ^ (const IPAddressBits& other) const;
+    IPAddressBits operator ~ () const;
+    IPAddressBits operator + (const IPAddressBits& other) const;
+    IPAddressBits operator - (const IPAddressBits& other) const;
+
+    bool operator == (const IPAddressBits& other) const;
+    bool operator != (const IPAddressBits& other) const;
+    bool operator < (const IPAddressBits& other) const;
+    bool operator <= (const IPAddressBits& other) const;
+
+    /// \brief Calculate a well-mixed hash of the value.
+    /// \param seed Extra state to mix in, such as a family or prefix.
+    /// \returns the hash.
+    std::size_t hash(uint64_t seed = 0) const;
+
+    /// \brief Mix the bits of a 64-bit word.
+    ///
+    /// This is the MurmurHash3 64-bit finalizer. It is a bijection, so
+    /// distinct inputs always give distinct outputs.
+    ///
+    /// \param value The word.
+    /// \returns the mixed word.
+    static uint64_t mix64(uint64_t value);
+
+    /// \brief Count the leading zero bits of a 64-bit word.
+    /// \param value The word.
+    /// \returns the number of leading zero bits, or 64 if value is zero.
+    static unsigned countLeadingZeros64(uint64_t value);
+
+};
+
+
+inline IPAddressBits IPAddressBits::load(const uint8_t* bytes, std::size_t length)
+{
+    IPAddressBits result = { 0, 0 };
+
+    if (length == 16)
+    {
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            result.high = (result.high << 8) | bytes[i];
+            result.low = (result.low << 8) | bytes[i + 8];
+        }
+    }
+    else
+    {
+        result.high = (uint64_t(bytes[0]) << 56)
+                    | (uint64_t(bytes[1]) << 48)
+                    | (uint64_t(bytes[2]) << 40)
+                    | (uint64_t(bytes[3]) << 32);
+    }
+
+    return result;
+}
+
+
+inline void IPAddressBits::store(uint8_t* bytes, std::size_t length) const
+{
+    for (std::size_t i = 0; i < 8 && i < length; ++i)
+        bytes[i] = static_cast<uint8_t>(high >> (56 - 8 * i));
+
+    for (std::size_t i = 8; i < length; ++i)
+        bytes[i] = static_cast<uint8_t>(low >> (120 - 8 * i));
+}
+
+
+inline IPAddressBits IPAddressBits::mask(unsigned prefix)
+{
+    // Shifting a 64-bit word by 64 is undefined, so each word is selected.
+    const unsigned highBits = prefix < 64 ? prefix : 64;
+    const unsigned lowBits = prefix > 64 ? prefix - 64 : 0;
+
+    IPAddressBits result;
+    result.high = highBits ? ~uint64_t(0) << (64 - highBits) : 0;
+    result.low = lowBits ? ~uint64_t(0) << (64 - lowBits) : 0;
+    return result;
+}
+
+
+inline bool IPAddressBits::matches(const IPAddressBits& a,
+                                   const IPAddressBits& b,
+                                   unsigned prefix)
+{
+    return ((a ^ b) & mask(prefix)).isZero();
+}
+
+
+inline unsigned IPAddressBits::countLeadingZeros() const
+{
+    return high ? countLeadingZeros64(high) : 64 + countLeadingZeros64(low);
+}
+
+
+inline unsigned IPAddressBits::countTrailingZeros() const
+{
+    // Isolate the lowest set bit and count the zeros above it.
+    if (low)
+        return 63 - countLeadingZeros64(low & (~low + 1));
+    else if (high)
+        return 64 + 63 - countLeadingZeros64(high & (~high + 1));
+    else
+        return 128;
+}
+
+
+inline IPAddressBits IPAddressBits::shiftLeft(unsigned count) const
+{
+    IPAddressBits result = { 0, 0 };
+
+    if (count == 0)
+        result = *this;
+    else if (count < 64)
+        result = { (high << count) | (low >> (64 - count)), low << count };
+    else if (count < 128)
+        result = { low << (count - 64), 0 };
+
+    return result;
+}
+
+
+inline IPAddressBits IPAddressBits::shiftRight(unsigned count) const
+{
+    IPAddressBits result = { 0, 0 };
+
+    if (count == 0)
+        result = *this;
+    else if (count < 64)
+        result = { high >> count, (low >> count) | (high << (64 - count)) };
+    else if (count < 128)
+        result = { 0, high >> (count - 64) };
+
+    return result;
+}
+
+
+inline bool IPAddressBits::bit(unsigned index) const
+{
+    return index < 64 ? (high >> (63 - index)) & 1 : (low >> (127 - index)) & 1;
+}
+
+
+inline bool IPAddressBits::isZero() const
+{
+    return (high | low) == 0;
+}
+
+
+inline IPAddressBits IPAddressBits::operator & (const IPAddressBits& other) const
+{
+    IPAddressBits result = { high & other.high, low & other.low };
+    return result;
+}
+
+
+inline IPAddressBits IPAddressBits::operator | (const IPAddressBits& other) const
+{
+    IPAddressBits result = { high | other.high, low | other.low };
+    return result;
+}
+
+
+inline IPAddressBits IPAddressBits::operator ^ (const IPAddressBits& other) const
+{
+    IPAddressBits result = { high ^ other.high, low ^ other.low };
+    return result;
+}
+
+
+inline IPAddressBits IPAddressBits::operator ~ () const
+{
+    IPAddressBits result = { ~high, ~low };
+    return result;
+}
+
+
+inline IPAddressBits IPAddressBits::operator + (const IPAddressBits& other) const
+{
+    IPAddressBits result = { high + other.high, low + other.low };
+    result.high += result.low < low;
+    return result;
+}
+
+
+inline IPAddressBits IPAddressBits::operator - (const IPAddressBits& other) const
+{
+    IPAddressBits result = { high - other.high, low - other.low };
+    result.high -= low < other.low;
+    return result;
+}
+
+
+inline bool IPAddressBits::operator == (const IPAddressBits& other) const
+{
+    return ((high ^ other.high) | (low ^ other.low)) == 0;
+}
+
+
+inline bool IPAddressBits::operator != (const IPAddressBits& other) const
+{
+    return !(*this == other);
+}
+
+
+inline bool IPAddressBits::operator < (const IPAddressBits& other) const
+{
+    return high < other.high || (high == other.high && low < other.low);
+}
+
+
+inline bool IPAddressBits::operator <= (const IPAddressBits& other) const
+{
+    return !(other < *this);
+}
+
+
+inline std::size_t IPAddressBits::hash(uint64_t seed) const
+{
+    return static_cast<std::size_t>(mix64(high ^ mix64(low ^ mix64(seed + 1))));
+}
+
+
+inline uint64_t IPAddressBits::mix64(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+
+inline unsigned IPAddressBits::countLeadingZeros64(uint64_t value)
+{
+    if (value == 0)
+        return 64;
+
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, value);
+    return 63 - static_cast<unsigned>(index);
+#else
+    unsigned result = 0;
+
+    while ((value & (uint64_t(1) << 63)) == 0)
+    {
+        value <<= 1;
+        ++result;
+    }
+
+    return result;
+#endif
+}
+
+
+} } // namespace ofx::Net
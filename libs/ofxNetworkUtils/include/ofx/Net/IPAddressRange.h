@@ -8,9 +8,12 @@
 #pragma once
 
 
+#include <functional>
 #include <vector>
 #include "Poco/Net/IPAddress.h"
 #include "ofConstants.h"
+#include "ofx/Net/CompactIPAddressRange.h"
+#include "ofx/Net/IPAddressSequence.h"
 
 
 namespace ofx {
@@ -21,6 +24,10 @@ namespace Net {
 ///
 /// Address ranges can be defined using CIDR notation and subnets.
 ///
+/// Internally a range is stored as a CompactIPAddressRange. Poco::Net::IPAddress
+/// values are only created when requested by an accessor. IPv6 scope ids are
+/// not preserved.
+///
 /// \sa https://en.wikipedia.org/wiki/Classless_Inter-Domain_Routing
 class IPAddressRange
 {
@@ -39,6 +46,11 @@ public:
     /// If no mask can be found a mask of /32 will be used for IPv4 addresses
     /// and a mask of /128 will be used for IPv6 addresses.
     ///
+    /// Addresses are parsed with IPAddressRangeParser. Anything it rejects is
+    /// passed to Poco::Net::IPAddress::tryParse(), so platform forms such as
+    /// the inet_aton short forms ("10.1", "10") are still accepted here.
+    /// IPAddressRangeParser::load() does not accept them.
+    ///
     /// \param CIDR CIDR style address range.
     /// \sa https://en.wikipedia.org/wiki/Classless_Inter-Domain_Routing
     IPAddressRange(const std::string& CIDR);
@@ -56,6 +68,10 @@ public:
     /// \param prefix The prefix used to create the mask.
     IPAddressRange(const Poco::Net::IPAddress& address, unsigned prefix);
 
+    /// \brief Create a range from a compact range.
+    /// \param range The compact range.
+    IPAddressRange(const CompactIPAddressRange& range);
+
     /// \brief Destroy the IPAddressRange.
     virtual ~IPAddressRange();
 
@@ -108,14 +124,49 @@ public:
     /// \returns the largest IPAddress in this range.
     Poco::Net::IPAddress hostMin() const;
 
+    /// \returns a lazy sequence of every address in this range.
+    IPAddressSequence<CompactIPAddress> hosts() const;
+
+    /// \brief Get a lazy sequence of evenly spaced addresses in this range.
+    ///
+    /// This is useful for sampling ranges that are too large to walk, such as
+    /// an IPv6 /64.
+    ///
+    /// \param stride The number of addresses between consecutive elements.
+    /// \returns the sequence, starting at hostMin().
+    IPAddressSequence<CompactIPAddress> strided(uint64_t stride) const;
+
+    /// \brief Get a lazy sequence of evenly spaced addresses in this range.
+    /// \param stride The number of addresses between consecutive elements.
+    /// \returns the sequence, starting at hostMin().
+    IPAddressSequence<CompactIPAddress> strided(const IPAddressBits& stride) const;
+
+    /// \brief Get a lazy sequence of the sub-ranges of this range.
+    ///
+    /// For example, 10.0.0.0/16 split with a prefix of 24 gives 256 /24
+    /// ranges. The sequence is empty if prefix is shorter than the prefix of
+    /// this range.
+    ///
+    /// \param prefix The prefix length of each sub-range.
+    /// \returns the sequence.
+    IPAddressSequence<CompactIPAddressRange> subnets(unsigned prefix) const;
+
     /// \returns the IPAddress::Family (IPV4 or IPV6) for this range.
     Poco::Net::IPAddress::Family family() const;
 
+    /// \returns the compact representation of this IPAddressRange.
+    const CompactIPAddressRange& compact() const;
+
     /// \returns a the CIDR representation of this IPAddressRange.
     std::string toString() const;
 
     bool operator == (const IPAddressRange& range) const;
     bool operator != (const IPAddressRange& range) const;
+
+    /// \brief Order by family, then by subnet, then by prefix length.
+    ///
+    /// This is a strict weak ordering, so ranges can be sorted, used as
+    /// std::map keys and searched with std::lower_bound.
     bool operator <  (const IPAddressRange& range) const;
     bool operator <= (const IPAddressRange& range) const;
     bool operator >  (const IPAddressRange& range) const;
@@ -130,39 +181,13 @@ public:
 #endif
 
 private:
-    /// \brief Poco bitwise operators are broken for IPv6.
-    /// \sa https://github.com/pocoproject/poco/issues/1552
-    enum class BitwiseOp
-    {
-        AND,
-        OR,
-        XOR
-    };
-
-    /// \brief Poco bitwise operators are broken for IPv6.
-    /// \sa https://github.com/pocoproject/poco/issues/1552
-    static Poco::Net::IPAddress bitwiseOp(const Poco::Net::IPAddress& address,
-                                          const Poco::Net::IPAddress& mask,
-                                          BitwiseOp op);
-
     /// \brief Get the maximum prefix length for the given IPAddress family.
     /// \param family The IPAddress family.
     /// \returns the maximum prefix length for the given family.
     static unsigned maximumPrefix(Poco::Net::IPAddress::Family family);
 
-    /// \brief Get the maximum prefix IPAddress for the given IPAddress family.
-    /// \param family The IPAddress family.
-    /// \returns the maximum prefix IPAddress for the given family.
-    static const Poco::Net::IPAddress& maximumPrefixIPAddress(Poco::Net::IPAddress::Family family);
-
-    /// \brief The IP address.
-    Poco::Net::IPAddress _address;
-
-    /// \brief The IP address mask.
-    Poco::Net::IPAddress _mask;
-
-    /// \brief The IP address subnet.
-    Poco::Net::IPAddress _subnet;
+    /// \brief The address and prefix.
+    CompactIPAddressRange _range;
 
     /// \brief Output the IPAddressRange in CIDR notation.
     /// \param os The output stream.
@@ -183,3 +208,19 @@ inline std::ostream& operator << (std::ostream& os,
 
 
 } } // namespace ofx::Net
+
+
+namespace std {
+
+
+template<>
+struct hash<ofx::Net::IPAddressRange>
+{
+    std::size_t operator()(const ofx::Net::IPAddressRange& range) const
+    {
+        return range.compact().hash();
+    }
+};
+
+
+} // namespace std
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ofx/Net/CompactIPAddressRange.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief Test arrays of addresses against one range or a small set of ranges.
+///
+/// IPv4 addresses are passed as uint32_t values in network byte order (the
+/// same layout as in_addr::s_addr). IPv6 addresses are passed as consecutive
+/// 16-byte arrays in network byte order.
+///
+/// Results are written either as a bitmap, where bit (i % 64) of word
+/// (i / 64) is set if address i matched, or as one range index per address.
+///
+/// On x86 an SSE2 or AVX2 kernel is selected at runtime, with a scalar
+/// fallback for other architectures.
+class IPAddressRangeBatch
+{
+public:
+    /// \brief The available kernels.
+    enum class Kernel
+    {
+        /// \brief Portable scalar code.
+        SCALAR,
+        /// \brief SSE2 mask-and-compare code.
+        SSE2,
+        /// \brief AVX2 mask-and-compare code.
+        AVX2
+    };
+
+    /// \brief Test IPv4 addresses against a range.
+    /// \param range The range to test against.
+    /// \param addresses The addresses, in network byte order.
+    /// \param count The number of addresses.
+    /// \param bitmap The output bitmap, at least bitmapSize(count) words.
+    /// \returns the number of matching addresses.
+    static std::size_t containsIPv4(const CompactIPAddressRange& range,
+                                    const uint32_t* addresses,
+                                    std::size_t count,
+                                    uint64_t* bitmap);
+
+    /// \brief Test IPv6 addresses against a range.
+    /// \param range The range to test against.
+    /// \param addresses The addresses, count * 16 bytes.
+    /// \param count The number of addresses.
+    /// \param bitmap The output bitmap, at least bitmapSize(count) words.
+    /// \returns the number of matching addresses.
+    static std::size_t containsIPv6(const CompactIPAddressRange& range,
+                                    const uint8_t* addresses,
+                                    std::size_t count,
+                                    uint64_t* bitmap);
+
+    /// \brief Find the first matching range for each IPv4 address.
+    /// \param ranges The ranges to test against, in priority order.
+    /// \param rangeCount The number of ranges.
+    /// \param addresses The addresses, in network byte order.
+    /// \param count The number of addresses.
+    /// \param indices The output range indices, NO_MATCH if none matched.
+    /// \returns the number of matching addresses.
+    static std::size_t matchIPv4(const CompactIPAddressRange* ranges,
+                                 std::size_t rangeCount,
+                                 const uint32_t* addresses,
+                                 std::size_t count,
+                                 int32_t* indices);
+
+    /// \brief Find the first matching range for each IPv6 address.
+    /// \param ranges The ranges to test against, in priority order.
+    /// \param rangeCount The number of ranges.
+    /// \param addresses The addresses, count * 16 bytes.
+    /// \param count The number of addresses.
+    /// \param indices The output range indices, NO_MATCH if none matched.
+    /// \returns the number of matching addresses.
+    static std::size_t matchIPv6(const CompactIPAddressRange* ranges,
+                                 std::size_t rangeCount,
+                                 const uint8_t* addresses,
+                                 std::size_t count,
+                                 int32_t* indices);
+
+    /// \param count The number of addresses.
+    /// \returns the number of 64-bit bitmap words needed for count addresses.
+    static std::size_t bitmapSize(std::size_t count);
+
+    /// \returns the kernel currently in use.
+    static Kernel kernel();
+
+    /// \brief Force a kernel.
+    ///
+    /// This is intended for benchmarking. Kernels not supported by the CPU
+    /// are ignored.
+    ///
+    /// \param kernel The kernel to use.
+    /// \returns true iff the kernel was selected.
+    static bool setKernel(Kernel kernel);
+
+    /// \returns true iff the kernel can run on this CPU.
+    static bool isSupported(Kernel kernel);
+
+    /// \returns the best kernel supported by this CPU.
+    static Kernel bestKernel();
+
+    /// \returns the name of the kernel.
+    static std::string toString(Kernel kernel);
+
+    enum
+    {
+        /// \brief The index written for addresses without a matching range.
+        NO_MATCH = -1
+    };
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include "ofx/Net/CompactIPAddressRange.h"
+#include "ofx/Net/IPAddressRange.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief An allocation-free, exception-free CIDR parser.
+///
+/// Parses dotted-quad IPv4 addresses, IPv6 addresses (including :: compression
+/// and an embedded dotted-quad IPv4 suffix) and an optional /prefix. IPv6 zone
+/// ids (e.g. %eth0) are accepted and discarded.
+///
+/// Errors are reported through return codes and never logged.
+class IPAddressRangeParser
+{
+public:
+    /// \brief Parse error codes.
+    enum class Error
+    {
+        /// \brief No error.
+        NONE,
+        /// \brief The input was empty.
+        EMPTY,
+        /// \brief The address could not be parsed.
+        INVALID_ADDRESS,
+        /// \brief The prefix was not a decimal number.
+        INVALID_PREFIX,
+        /// \brief The prefix was larger than the address family allows.
+        PREFIX_OUT_OF_RANGE
+    };
+
+    /// \brief A parse error found during a bulk load.
+    struct LineError
+    {
+        /// \brief The 1-based line number.
+        std::size_t line;
+
+        /// \brief The 1-based column where the error was detected.
+        std::size_t column;
+
+        /// \brief The error.
+        Error error;
+    };
+
+    /// \brief Parse an address without a prefix.
+    /// \param first The first character.
+    /// \param last One past the last character.
+    /// \param address The parsed address, unchanged on error.
+    /// \param position If not nullptr, set to the error location on error.
+    /// \returns Error::NONE on success.
+    static Error parseAddress(const char* first,
+                              const char* last,
+                              CompactIPAddress& address,
+                              const char** position = nullptr);
+
+    /// \brief Parse a decimal prefix length.
+    /// \param first The first character.
+    /// \param last One past the last character.
+    /// \param maximumPrefix The largest allowed prefix length.
+    /// \param prefix The parsed prefix, unchanged on error.
+    /// \param position If not nullptr, set to the error location on error.
+    /// \returns Error::NONE on success.
+    static Error parsePrefix(const char* first,
+                             const char* last,
+                             unsigned maximumPrefix,
+                             unsigned& prefix,
+                             const char** position = nullptr);
+
+    /// \brief Parse an address with an optional /prefix.
+    ///
+    /// If no prefix is given, /32 is used for IPv4 and /128 for IPv6.
+    ///
+    /// \param first The first character.
+    /// \param last One past the last character.
+    /// \param range The parsed range, unchanged on error.
+    /// \param position If not nullptr, set to the error location on error.
+    /// \returns Error::NONE on success.
+    static Error parse(const char* first,
+                       const char* last,
+                       CompactIPAddressRange& range,
+                       const char** position = nullptr);
+
+    /// \brief Parse an address with an optional /prefix.
+    /// \param CIDR The CIDR string.
+    /// \param range The parsed range, unchanged on error.
+    /// \returns Error::NONE on success.
+    static Error parse(const std::string& CIDR, CompactIPAddressRange& range);
+
+    /// \brief Parse one range per line from a buffer.
+    ///
+    /// Leading and trailing whitespace is ignored, as are blank lines and
+    /// anything after a #. Lines that fail to parse are skipped.
+    ///
+    /// \param first The first character.
+    /// \param last One past the last character.
+    /// \param ranges The list to append parsed ranges to.
+    /// \param errors If not nullptr, per-line errors are appended.
+    /// \returns the number of ranges appended.
+    static std::size_t load(const char* first,
+                            const char* last,
+                            IPAddressRange::List& ranges,
+                            std::vector<LineError>* errors = nullptr);
+
+    /// \brief Parse one range per line from a file.
+    ///
+    /// The file is streamed in fixed size blocks rather than read into
+    /// memory at once. The path is resolved with ofToDataPath().
+    ///
+    /// \param path The file path.
+    /// \param ranges The list to append parsed ranges to.
+    /// \param errors If not nullptr, per-line errors are appended.
+    /// \returns false if the file could not be read.
+    static bool loadFile(const std::string& path,
+                         IPAddressRange::List& ranges,
+                         std::vector<LineError>* errors = nullptr);
+
+    /// \returns a description of the error.
+    static std::string toString(Error error);
+
+private:
+    /// \brief Parse complete lines from a buffer.
+    /// \param first The first character.
+    /// \param last One past the last character.
+    /// \param line The number of the first line, advanced past each line.
+    /// \param ranges The list to append parsed ranges to.
+    /// \param errors If not nullptr, per-line errors are appended.
+    /// \returns the number of ranges appended.
+    static std::size_t loadLines(const char* first,
+                                 const char* last,
+                                 std::size_t& line,
+                                 IPAddressRange::List& ranges,
+                                 std::vector<LineError>* errors);
+
+};
+
+
+} } // namespace ofx::Net
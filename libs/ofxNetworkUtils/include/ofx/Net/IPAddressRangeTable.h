@@ -0,0 +1,406 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Poco/Net/IPAddress.h"
+#include "ofLog.h"
+#include "ofx/Net/CompactIPAddressRange.h"
+#include "ofx/Net/IPAddressRange.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A longest-prefix-match table of IPAddressRanges.
+///
+/// The table is a path-compressed binary radix (Patricia) trie with one root
+/// for IPv4 and one for IPv6. Each stored range carries a user payload. A
+/// lookup walks at most one node per prefix bit, never allocates and returns
+/// the most specific matching range.
+///
+/// Nodes and entries are stored in contiguous arrays and refer to each other
+/// by index.
+///
+/// \tparam T The payload type.
+template<typename T>
+class IPAddressRangeTable
+{
+public:
+    /// \brief A stored range and its payload.
+    struct Entry
+    {
+        /// \brief The range as inserted.
+        CompactIPAddressRange range;
+
+        /// \brief The user payload.
+        T value;
+    };
+
+    /// \brief Create an empty table.
+    IPAddressRangeTable();
+
+    /// \brief Add a range.
+    ///
+    /// If a range with the same subnet and prefix is already stored, its
+    /// entry is replaced.
+    ///
+    /// \param range The range to add.
+    /// \param value The payload for the range.
+    void insert(const CompactIPAddressRange& range, const T& value);
+
+    /// \brief Add a range.
+    /// \param range The range to add.
+    /// \param value The payload for the range.
+    void insert(const IPAddressRange& range, const T& value);
+
+    /// \brief Add a list of ranges that share a payload.
+    /// \param ranges The ranges to add.
+    /// \param value The payload for all ranges.
+    void insert(const IPAddressRange::List& ranges, const T& value);
+
+    /// \brief Add a list of ranges with one payload per range.
+    /// \param ranges The ranges to add.
+    /// \param values The payloads, in the same order as the ranges.
+    void insert(const IPAddressRange::List& ranges, const std::vector<T>& values);
+
+    /// \brief Find the most specific range containing an address.
+    ///
+    /// The returned pointer is invalidated by the next insert() or clear().
+    ///
+    /// \param address The address to look up.
+    /// \returns the matching entry or nullptr if no range matches.
+    const Entry* find(const CompactIPAddress& address) const;
+
+    /// \brief Find the most specific range containing an address.
+    /// \param address The address to look up.
+    /// \returns the matching entry or nullptr if no range matches.
+    const Entry* find(const Poco::Net::IPAddress& address) const;
+
+    /// \brief Find the entry stored for exactly this subnet and prefix.
+    /// \param range The range to look up.
+    /// \returns the matching entry or nullptr if it is not stored.
+    const Entry* findExact(const CompactIPAddressRange& range) const;
+
+    /// \returns all stored entries in insertion order.
+    const std::vector<Entry>& entries() const;
+
+    /// \returns the number of stored ranges.
+    std::size_t size() const;
+
+    /// \returns true iff no ranges are stored.
+    bool empty() const;
+
+    /// \brief Remove all ranges.
+    void clear();
+
+    /// \brief Reserve space for a number of ranges.
+    /// \param count The number of ranges.
+    void reserve(std::size_t count);
+
+    enum
+    {
+        /// \brief The index used for missing nodes and entries.
+        NONE = 0xFFFFFFFF
+    };
+
+private:
+    /// \brief A trie node.
+    struct Node
+    {
+        /// \brief The node's subnet with all bits after prefix cleared.
+        CompactIPAddress key;
+
+        /// \brief The number of significant bits in key.
+        uint8_t prefix;
+
+        /// \brief The child node indices, selected by the bit after prefix.
+        uint32_t children[2];
+
+        /// \brief The entry index, or NONE for internal nodes.
+        uint32_t entry;
+    };
+
+    /// \brief Append a node.
+    uint32_t addNode(const CompactIPAddress& key, unsigned prefix, uint32_t entry);
+
+    /// \brief Append an entry.
+    uint32_t addEntry(const CompactIPAddressRange& range, const T& value);
+
+    /// \returns the root index slot for the given family.
+    uint32_t& rootIndex(CompactIPAddress::Family family);
+    uint32_t rootIndex(CompactIPAddress::Family family) const;
+
+    /// \brief The trie nodes.
+    std::vector<Node> _nodes;
+
+    /// \brief The stored entries.
+    std::vector<Entry> _entries;
+
+    /// \brief The IPv4 root node index.
+    uint32_t _rootIPv4 = NONE;
+
+    /// \brief The IPv6 root node index.
+    uint32_t _rootIPv6 = NONE;
+
+};
+
+
+template<typename T>
+IPAddressRangeTable<T>::IPAddressRangeTable()
+{
+}
+
+
+template<typename T>
+void IPAddressRangeTable<T>::insert(const CompactIPAddressRange& range,
+                                    const T& value)
+{
+    const unsigned prefix = range.prefix();
+    const CompactIPAddress key = range.subnet();
+
+    // The parent node and the child slot leading to the current node.
+    uint32_t parent = NONE;
+    unsigned slot = 0;
+    uint32_t current = rootIndex(key.family());
+
+    while (current != NONE)
+    {
+        const Node node = _nodes[current];
+        const unsigned common = std::min(key.commonPrefixLength(node.key),
+                                         std::min(prefix, unsigned(node.prefix)));
+
+        uint32_t replacement = NONE;
+
+        if (common < node.prefix)
+        {
+            if (common == prefix)
+            {
+                // The new range is a parent of the current node.
+                replacement = addNode(key, prefix, addEntry(range, value));
+                _nodes[replacement].children[node.key.bit(prefix)] = current;
+            }
+            else
+            {
+                // The new range and the current node diverge after common bits.
+                replacement = addNode(key.masked(common), common, NONE);
+                uint32_t leaf = addNode(key, prefix, addEntry(range, value));
+                _nodes[replacement].children[key.bit(common)] = leaf;
+                _nodes[replacement].children[node.key.bit(common)] = current;
+            }
+        }
+        else if (node.prefix == prefix)
+        {
+            if (node.entry == NONE)
+                _nodes[current].entry = addEntry(range, value);
+            else
+                _entries[node.entry] = { range, value };
+            return;
+        }
+        else
+        {
+            parent = current;
+            slot = key.bit(node.prefix);
+            current = node.children[slot];
+            continue;
+        }
+
+        if (parent == NONE)
+            rootIndex(key.family()) = replacement;
+        else
+            _nodes[parent].children[slot] = replacement;
+
+        return;
+    }
+
+    uint32_t leaf = addNode(key, prefix, addEntry(range, value));
+
+    if (parent == NONE)
+        rootIndex(key.family()) = leaf;
+    else
+        _nodes[parent].children[slot] = leaf;
+}
+
+
+template<typename T>
+void IPAddressRangeTable<T>::insert(const IPAddressRange& range,
+                                    const T& value)
+{
+    insert(range.compact(), value);
+}
+
+
+template<typename T>
+void IPAddressRangeTable<T>::insert(const IPAddressRange::List& ranges,
+                                    const T& value)
+{
+    reserve(size() + ranges.size());
+
+    for (const auto& range: ranges)
+        insert(range.compact(), value);
+}
+
+
+template<typename T>
+void IPAddressRangeTable<T>::insert(const IPAddressRange::List& ranges,
+                                    const std::vector<T>& values)
+{
+    if (ranges.size() != values.size())
+    {
+        ofLogError("IPAddressRangeTable::insert") << "Range and value counts differ: " << ranges.size() << " != " << values.size();
+    }
+
+    std::size_t count = std::min(ranges.size(), values.size());
+
+    reserve(size() + count);
+
+    for (std::size_t i = 0; i < count; ++i)
+        insert(ranges[i].compact(), values[i]);
+}
+
+
+template<typename T>
+const typename IPAddressRangeTable<T>::Entry* IPAddressRangeTable<T>::find(const CompactIPAddress& address) const
+{
+    const Entry* result = nullptr;
+    uint32_t current = rootIndex(address.family());
+
+    while (current != NONE)
+    {
+        const Node& node = _nodes[current];
+
+        if (!node.key.matches(address, node.prefix))
+            break;
+
+        if (node.entry != NONE)
+            result = &_entries[node.entry];
+
+        if (node.prefix == address.bitLength())
+            break;
+
+        current = node.children[address.bit(node.prefix)];
+    }
+
+    return result;
+}
+
+
+template<typename T>
+const typename IPAddressRangeTable<T>::Entry* IPAddressRangeTable<T>::find(const Poco::Net::IPAddress& address) const
+{
+    return find(CompactIPAddress(address));
+}
+
+
+template<typename T>
+const typename IPAddressRangeTable<T>::Entry* IPAddressRangeTable<T>::findExact(const CompactIPAddressRange& range) const
+{
+    const CompactIPAddress key = range.subnet();
+    uint32_t current = rootIndex(key.family());
+
+    while (current != NONE)
+    {
+        const Node& node = _nodes[current];
+
+        if (node.prefix > range.prefix() || !node.key.matches(key, node.prefix))
+            break;
+
+        if (node.prefix == range.prefix())
+            return node.entry == NONE ? nullptr : &_entries[node.entry];
+
+        current = node.children[key.bit(node.prefix)];
+    }
+
+    return nullptr;
+}
+
+
+template<typename T>
+const std::vector<typename IPAddressRangeTable<T>::Entry>& IPAddressRangeTable<T>::entries() const
+{
+    return _entries;
+}
+
+
+template<typename T>
+std::size_t IPAddressRangeTable<T>::size() const
+{
+    return _entries.size();
+}
+
+
+template<typename T>
+bool IPAddressRangeTable<T>::empty() const
+{
+    return _entries.empty();
+}
+
+
+template<typename T>
+void IPAddressRangeTable<T>::clear()
+{
+    _nodes.clear();
+    _entries.clear();
+    _rootIPv4 = NONE;
+    _rootIPv6 = NONE;
+}
+
+
+template<typename T>
+void IPAddressRangeTable<T>::reserve(std::size_t count)
+{
+    // A Patricia trie has at most one internal node per stored range.
+    _nodes.reserve(count * 2);
+    _entries.reserve(count);
+}
+
+
+template<typename T>
+uint32_t IPAddressRangeTable<T>::addNode(const CompactIPAddress& key,
+                                          unsigned prefix,
+                                          uint32_t entry)
+{
+    Node node;
+    node.key = key;
+    node.prefix = static_cast<uint8_t>(prefix);
+    node.children[0] = NONE;
+    node.children[1] = NONE;
+    node.entry = entry;
+    _nodes.push_back(node);
+    return static_cast<uint32_t>(_nodes.size() - 1);
+}
+
+
+template<typename T>
+uint32_t IPAddressRangeTable<T>::addEntry(const CompactIPAddressRange& range,
+                                           const T& value)
+{
+    _entries.push_back({ range, value });
+    return static_cast<uint32_t>(_entries.size() - 1);
+}
+
+
+template<typename T>
+uint32_t& IPAddressRangeTable<T>::rootIndex(CompactIPAddress::Family family)
+{
+    return family == CompactIPAddress::IPv6 ? _rootIPv6 : _rootIPv4;
+}
+
+
+template<typename T>
+uint32_t IPAddressRangeTable<T>::rootIndex(CompactIPAddress::Family family) const
+{
+    return family == CompactIPAddress::IPv6 ? _rootIPv6 : _rootIPv4;
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,60 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/Net/IPAddressRange.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief Set operations over lists of IPAddressRanges.
+///
+/// Each list is treated as the set of addresses it covers. Lists are
+/// converted to sorted, disjoint address intervals, combined with a linear
+/// sweep and converted back to the minimal list of CIDR ranges that covers
+/// the result. All operations run in O(n log n) and handle IPv4 and IPv6
+/// ranges in the same list.
+///
+/// Results are sorted by family and then by address. Each result range has
+/// its host bits cleared.
+class IPAddressRangeUtils
+{
+public:
+    /// \brief Sort, remove duplicates and merge overlapping or adjacent ranges.
+    /// \param ranges The ranges to normalize.
+    /// \returns the minimal list of ranges covering the same addresses.
+    static IPAddressRange::List normalize(const IPAddressRange::List& ranges);
+
+    /// \brief Calculate the union of two lists.
+    /// \param a The first list.
+    /// \param b The second list.
+    /// \returns the addresses covered by a or b.
+    static IPAddressRange::List unite(const IPAddressRange::List& a,
+                                      const IPAddressRange::List& b);
+
+    /// \brief Calculate the intersection of two lists.
+    /// \param a The first list.
+    /// \param b The second list.
+    /// \returns the addresses covered by both a and b.
+    static IPAddressRange::List intersect(const IPAddressRange::List& a,
+                                          const IPAddressRange::List& b);
+
+    /// \brief Calculate the difference of two lists.
+    /// \param a The list to subtract from.
+    /// \param b The list to subtract.
+    /// \returns the addresses covered by a but not by b.
+    static IPAddressRange::List subtract(const IPAddressRange::List& a,
+                                         const IPAddressRange::List& b);
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,313 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <iterator>
+#include "ofx/Net/CompactIPAddressRange.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A lazy, allocation-free sequence of addresses or sub-ranges.
+///
+/// The sequence starts at the subnet of a range and advances by a fixed
+/// stride until it passes the end of the range. Each element is an aligned
+/// block of 2^(bit length - prefix) addresses. With the full prefix the
+/// elements are single hosts, and with a shorter prefix they are subnets.
+///
+/// Values are computed as the iterator advances. Nothing is stored besides
+/// the current position, so even an IPv6 /0 can be walked without
+/// materializing it.
+///
+/// IPAddressRange::hosts(), IPAddressRange::strided() and
+/// IPAddressRange::subnets() create the common sequences:
+///
+///     for (const auto& address: range.hosts())
+///         ...
+///
+///     for (const auto& subnet: range.subnets(24))
+///         ...
+///
+/// \tparam T Either CompactIPAddress or CompactIPAddressRange.
+template<typename T>
+class IPAddressSequence
+{
+public:
+    /// \brief A forward iterator over the sequence.
+    class Iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        /// \brief Create an end iterator.
+        Iterator();
+
+        reference operator * () const;
+        pointer operator -> () const;
+
+        Iterator& operator ++ ();
+        Iterator operator ++ (int);
+
+        bool operator == (const Iterator& other) const;
+        bool operator != (const Iterator& other) const;
+
+    private:
+        friend class IPAddressSequence;
+
+        /// \brief Create an iterator at the first element.
+        /// \param sequence The sequence to iterate.
+        explicit Iterator(const IPAddressSequence& sequence);
+
+        /// \brief Update the current value from the current position.
+        void update();
+
+        /// \brief The numeric value of the current element.
+        IPAddressBits _current;
+
+        /// \brief The numeric value of the last element.
+        IPAddressBits _last;
+
+        /// \brief The numeric distance between elements.
+        IPAddressBits _stride;
+
+        /// \brief The address family.
+        CompactIPAddress::Family _family;
+
+        /// \brief The prefix length of each element.
+        uint8_t _prefix;
+
+        /// \brief True iff the iterator is past the last element.
+        bool _end;
+
+        /// \brief The current element.
+        T _value;
+
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    /// \brief Create a sequence.
+    ///
+    /// The sequence is empty if prefix is shorter than the prefix of range.
+    ///
+    /// \param range The range to walk.
+    /// \param prefix The prefix length of each element, clamped to the family maximum.
+    /// \param stride The number of addresses between the starts of two
+    ///        consecutive elements. A stride of zero is treated as one.
+    IPAddressSequence(const CompactIPAddressRange& range,
+                      unsigned prefix,
+                      const IPAddressBits& stride);
+
+    /// \returns an iterator at the first element.
+    Iterator begin() const;
+
+    /// \returns an iterator past the last element.
+    Iterator end() const;
+
+    /// \returns true iff the sequence has no elements.
+    bool empty() const;
+
+private:
+    /// \brief Create an element.
+    static void make(const IPAddressBits& bits,
+                     CompactIPAddress::Family family,
+                     unsigned prefix,
+                     CompactIPAddress& value);
+
+    /// \brief Create an element.
+    static void make(const IPAddressBits& bits,
+                     CompactIPAddress::Family family,
+                     unsigned prefix,
+                     CompactIPAddressRange& value);
+
+    /// \brief The numeric value of the first element.
+    IPAddressBits _first;
+
+    /// \brief The numeric value of the last element.
+    IPAddressBits _last;
+
+    /// \brief The numeric distance between elements.
+    IPAddressBits _stride;
+
+    /// \brief The address family.
+    CompactIPAddress::Family _family;
+
+    /// \brief The prefix length of each element.
+    uint8_t _prefix;
+
+    /// \brief True iff the sequence has no elements.
+    bool _empty;
+
+};
+
+
+template<typename T>
+IPAddressSequence<T>::Iterator::Iterator():
+    _current({ 0, 0 }),
+    _last({ 0, 0 }),
+    _stride({ 0, 1 }),
+    _family(CompactIPAddress::IPv4),
+    _prefix(0),
+    _end(true),
+    _value()
+{
+}
+
+
+template<typename T>
+IPAddressSequence<T>::Iterator::Iterator(const IPAddressSequence& sequence):
+    _current(sequence._first),
+    _last(sequence._last),
+    _stride(sequence._stride),
+    _family(sequence._family),
+    _prefix(sequence._prefix),
+    _end(sequence._empty),
+    _value()
+{
+    update();
+}
+
+
+template<typename T>
+typename IPAddressSequence<T>::Iterator::reference IPAddressSequence<T>::Iterator::operator * () const
+{
+    return _value;
+}
+
+
+template<typename T>
+typename IPAddressSequence<T>::Iterator::pointer IPAddressSequence<T>::Iterator::operator -> () const
+{
+    return &_value;
+}
+
+
+template<typename T>
+typename IPAddressSequence<T>::Iterator& IPAddressSequence<T>::Iterator::operator ++ ()
+{
+    // Compare the remaining distance rather than the sum to avoid overflow.
+    if (_end || _last - _current < _stride)
+    {
+        _end = true;
+    }
+    else
+    {
+        _current = _current + _stride;
+        update();
+    }
+
+    return *this;
+}
+
+
+template<typename T>
+typename IPAddressSequence<T>::Iterator IPAddressSequence<T>::Iterator::operator ++ (int)
+{
+    Iterator result = *this;
+    ++(*this);
+    return result;
+}
+
+
+template<typename T>
+bool IPAddressSequence<T>::Iterator::operator == (const Iterator& other) const
+{
+    return _end == other._end && (_end || _current == other._current);
+}
+
+
+template<typename T>
+bool IPAddressSequence<T>::Iterator::operator != (const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+
+template<typename T>
+void IPAddressSequence<T>::Iterator::update()
+{
+    if (!_end)
+        make(_current, _family, _prefix, _value);
+}
+
+
+template<typename T>
+IPAddressSequence<T>::IPAddressSequence(const CompactIPAddressRange& range,
+                                        unsigned prefix,
+                                        const IPAddressBits& stride):
+    _family(range.family()),
+    _prefix(0),
+    _empty(false)
+{
+    const unsigned length = CompactIPAddress::maximumPrefix(_family);
+    const IPAddressBits one = { 0, 1 };
+
+    prefix = prefix < length ? prefix : length;
+
+    _prefix = static_cast<uint8_t>(prefix);
+    _empty = prefix < range.prefix();
+    _stride = stride.isZero() ? one : stride;
+
+    // Work with right-aligned numeric values so strides are plain integers.
+    const unsigned shift = 128 - length;
+    _first = range.hostMin().bits().shiftRight(shift);
+    _last = (range.hostMax().bits() & IPAddressBits::mask(prefix)).shiftRight(shift);
+}
+
+
+template<typename T>
+typename IPAddressSequence<T>::Iterator IPAddressSequence<T>::begin() const
+{
+    return Iterator(*this);
+}
+
+
+template<typename T>
+typename IPAddressSequence<T>::Iterator IPAddressSequence<T>::end() const
+{
+    return Iterator();
+}
+
+
+template<typename T>
+bool IPAddressSequence<T>::empty() const
+{
+    return _empty;
+}
+
+
+template<typename T>
+void IPAddressSequence<T>::make(const IPAddressBits& bits,
+                                CompactIPAddress::Family family,
+                                unsigned,
+                                CompactIPAddress& value)
+{
+    value = CompactIPAddress(bits.shiftLeft(128 - CompactIPAddress::maximumPrefix(family)), family);
+}
+
+
+template<typename T>
+void IPAddressSequence<T>::make(const IPAddressBits& bits,
+                                CompactIPAddress::Family family,
+                                unsigned prefix,
+                                CompactIPAddressRange& value)
+{
+    value = CompactIPAddressRange(CompactIPAddress(bits.shiftLeft(128 - CompactIPAddress::maximumPrefix(family)), family), prefix);
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,374 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Poco/Net/IPAddress.h"
+#include "ofLog.h"
+#include "ofx/Net/CompactIPAddressRange.h"
+#include "ofx/Net/IPAddressRange.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief An IPv4-only longest-prefix-match table in the DIR-24-8 layout.
+///
+/// The first level is a table of 2^24 slots indexed by the top 24 bits of an
+/// address. A slot holds either the index of the most specific entry for
+/// that /24 or, if a longer prefix falls inside it, the index of a 256-slot
+/// overflow block indexed by the last 8 bits. Lookups for addresses covered
+/// only by prefixes of /24 or shorter take one memory access, and all others
+/// take two.
+///
+/// Memory and speed compared to IPAddressRangeTable:
+///
+/// - The first level always uses 64 MiB, plus 1 KiB for each /24 that
+///   contains a prefix longer than /24. The trie uses roughly 60 bytes per
+///   range plus the payloads.
+/// - A lookup costs one or two dependent loads regardless of the number of
+///   ranges. A trie lookup walks one node per branching bit, which means
+///   several dependent cache misses for large tables.
+/// - The table is compiled in one pass with build(). Changing a range means
+///   rebuilding the table, while the trie supports incremental insert().
+/// - Only IPv4 is supported. IPv6 ranges passed to build() are ignored.
+///
+/// Use this table for large, mostly static IPv4 lists on hot paths, and
+/// IPAddressRangeTable for small lists, IPv6 or frequently changing data.
+///
+/// \tparam T The payload type.
+template<typename T>
+class IPv4AddressRangeTable
+{
+public:
+    /// \brief A stored range and its payload.
+    struct Entry
+    {
+        /// \brief The range as given to build().
+        CompactIPAddressRange range;
+
+        /// \brief The user payload.
+        T value;
+    };
+
+    enum
+    {
+        /// \brief The index returned when no range matches.
+        NONE = 0x7FFFFFFF
+    };
+
+    /// \brief Create an empty table.
+    ///
+    /// The first level table is not allocated until build() is called.
+    IPv4AddressRangeTable();
+
+    /// \brief Compile a table from a list of ranges that share a payload.
+    /// \param ranges The ranges to store.
+    /// \param value The payload for all ranges.
+    void build(const IPAddressRange::List& ranges, const T& value);
+
+    /// \brief Compile a table from a list of ranges with one payload per range.
+    ///
+    /// Any previous contents are replaced. If a range with the same subnet
+    /// and prefix appears more than once, the last one wins.
+    ///
+    /// \param ranges The ranges to store.
+    /// \param values The payloads, in the same order as the ranges.
+    void build(const IPAddressRange::List& ranges, const std::vector<T>& values);
+
+    /// \brief Find the most specific range containing an address.
+    /// \param address The address to look up.
+    /// \returns the matching entry or nullptr if no range matches or the
+    ///          address is not IPv4.
+    const Entry* find(const CompactIPAddress& address) const;
+
+    /// \brief Find the most specific range containing an address.
+    /// \param address The address to look up.
+    /// \returns the matching entry or nullptr if no range matches or the
+    ///          address is not IPv4.
+    const Entry* find(const Poco::Net::IPAddress& address) const;
+
+    /// \brief Find the most specific range containing an address.
+    /// \param address The address in network byte order.
+    /// \returns the index of the matching entry or NONE.
+    uint32_t findIndex(uint32_t address) const;
+
+    /// \brief Find the most specific range for each of a batch of addresses.
+    ///
+    /// The first level slots of upcoming addresses are prefetched, so the
+    /// memory accesses of several lookups overlap.
+    ///
+    /// \param addresses The addresses in network byte order.
+    /// \param count The number of addresses.
+    /// \param indices The output entry indices, NONE if no range matched.
+    /// \returns the number of matching addresses.
+    std::size_t find(const uint32_t* addresses,
+                     std::size_t count,
+                     uint32_t* indices) const;
+
+    /// \returns the stored IPv4 entries in the order given to build(),
+    ///          including duplicates that are shadowed by a later entry.
+    const std::vector<Entry>& entries() const;
+
+    /// \returns the number of stored entries.
+    std::size_t size() const;
+
+    /// \returns true iff no entries are stored.
+    bool empty() const;
+
+    /// \brief Remove all entries and release the tables.
+    void clear();
+
+    /// \returns the number of bytes used by the lookup tables.
+    std::size_t memoryUsage() const;
+
+private:
+    enum
+    {
+        /// \brief Set in a first level slot that refers to an overflow block.
+        OVERFLOW_FLAG = 0x80000000,
+
+        /// \brief The number of slots in an overflow block.
+        BLOCK_SIZE = 256
+    };
+
+    /// \brief Paint a range of first level slots.
+    void fillLevel1(uint32_t first, uint32_t count, uint32_t entry);
+
+    /// \brief Convert a network byte order address to a numeric value.
+    static uint32_t toHostOrder(uint32_t address);
+
+    /// \brief The stored entries.
+    std::vector<Entry> _entries;
+
+    /// \brief The first level table, indexed by the top 24 address bits.
+    std::vector<uint32_t> _level1;
+
+    /// \brief The overflow blocks, indexed by block and the low 8 address bits.
+    std::vector<uint32_t> _level2;
+
+};
+
+
+template<typename T>
+IPv4AddressRangeTable<T>::IPv4AddressRangeTable()
+{
+}
+
+
+template<typename T>
+void IPv4AddressRangeTable<T>::build(const IPAddressRange::List& ranges,
+                                     const T& value)
+{
+    build(ranges, std::vector<T>(ranges.size(), value));
+}
+
+
+template<typename T>
+void IPv4AddressRangeTable<T>::build(const IPAddressRange::List& ranges,
+                                     const std::vector<T>& values)
+{
+    if (ranges.size() != values.size())
+    {
+        ofLogError("IPv4AddressRangeTable::build") << "Range and value counts differ: " << ranges.size() << " != " << values.size();
+    }
+
+    const std::size_t count = std::min(ranges.size(), values.size());
+
+    clear();
+    _entries.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (ranges[i].compact().address().isIPv4())
+            _entries.push_back({ ranges[i].compact(), values[i] });
+    }
+
+    if (_entries.size() >= NONE)
+    {
+        ofLogError("IPv4AddressRangeTable::build") << "Too many ranges: " << _entries.size();
+        _entries.erase(_entries.begin() + (NONE - 1), _entries.end());
+    }
+
+    // Paint shorter prefixes first so that more specific ranges overwrite
+    // them. The sort is stable so later duplicates win.
+    std::vector<uint32_t> order(_entries.size());
+
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = static_cast<uint32_t>(i);
+
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return _entries[a].range.prefix() < _entries[b].range.prefix();
+    });
+
+    _level1.assign(std::size_t(1) << 24, uint32_t(NONE));
+
+    for (auto index: order)
+    {
+        const CompactIPAddressRange& range = _entries[index].range;
+        const uint32_t subnet = static_cast<uint32_t>(range.subnet().bits().high >> 32);
+        const unsigned prefix = range.prefix();
+
+        if (prefix <= 24)
+        {
+            fillLevel1(subnet >> 8, uint32_t(1) << (24 - prefix), index);
+            continue;
+        }
+
+        uint32_t& slot = _level1[subnet >> 8];
+
+        if ((slot & OVERFLOW_FLAG) == 0)
+        {
+            // Start a block that inherits the /24's current entry.
+            const uint32_t block = static_cast<uint32_t>(_level2.size() / BLOCK_SIZE);
+            _level2.resize(_level2.size() + BLOCK_SIZE, slot);
+            slot = OVERFLOW_FLAG | block;
+        }
+
+        const std::size_t offset = (slot & ~uint32_t(OVERFLOW_FLAG)) * std::size_t(BLOCK_SIZE);
+        const std::size_t first = offset + (subnet & 0xFF);
+        std::fill(_level2.begin() + first, _level2.begin() + first + (std::size_t(1) << (32 - prefix)), index);
+    }
+}
+
+
+template<typename T>
+const typename IPv4AddressRangeTable<T>::Entry* IPv4AddressRangeTable<T>::find(const CompactIPAddress& address) const
+{
+    if (!address.isIPv4())
+        return nullptr;
+
+    uint32_t value = 0;
+    std::memcpy(&value, address.bytes(), sizeof(value));
+
+    const uint32_t index = findIndex(value);
+    return index == NONE ? nullptr : &_entries[index];
+}
+
+
+template<typename T>
+const typename IPv4AddressRangeTable<T>::Entry* IPv4AddressRangeTable<T>::find(const Poco::Net::IPAddress& address) const
+{
+    return find(CompactIPAddress(address));
+}
+
+
+template<typename T>
+uint32_t IPv4AddressRangeTable<T>::findIndex(uint32_t address) const
+{
+    if (_level1.empty())
+        return NONE;
+
+    const uint32_t value = toHostOrder(address);
+    const uint32_t slot = _level1[value >> 8];
+
+    if ((slot & OVERFLOW_FLAG) == 0)
+        return slot;
+
+    return _level2[(slot & ~uint32_t(OVERFLOW_FLAG)) * std::size_t(BLOCK_SIZE) + (value & 0xFF)];
+}
+
+
+template<typename T>
+std::size_t IPv4AddressRangeTable<T>::find(const uint32_t* addresses,
+                                           std::size_t count,
+                                           uint32_t* indices) const
+{
+    if (_level1.empty())
+    {
+        std::fill(indices, indices + count, uint32_t(NONE));
+        return 0;
+    }
+
+    // How far ahead to prefetch. Roughly the number of misses a core can
+    // keep in flight.
+    const std::size_t distance = 8;
+
+    const uint32_t* level1 = _level1.data();
+    std::size_t matches = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        if (i + distance < count)
+            __builtin_prefetch(&level1[toHostOrder(addresses[i + distance]) >> 8]);
+#endif
+
+        const uint32_t index = findIndex(addresses[i]);
+        indices[i] = index;
+        matches += index != NONE;
+    }
+
+    return matches;
+}
+
+
+template<typename T>
+const std::vector<typename IPv4AddressRangeTable<T>::Entry>& IPv4AddressRangeTable<T>::entries() const
+{
+    return _entries;
+}
+
+
+template<typename T>
+std::size_t IPv4AddressRangeTable<T>::size() const
+{
+    return _entries.size();
+}
+
+
+template<typename T>
+bool IPv4AddressRangeTable<T>::empty() const
+{
+    return _entries.empty();
+}
+
+
+template<typename T>
+void IPv4AddressRangeTable<T>::clear()
+{
+    _entries.clear();
+    std::vector<uint32_t>().swap(_level1);
+    std::vector<uint32_t>().swap(_level2);
+}
+
+
+template<typename T>
+std::size_t IPv4AddressRangeTable<T>::memoryUsage() const
+{
+    return (_level1.capacity() + _level2.capacity()) * sizeof(uint32_t);
+}
+
+
+template<typename T>
+void IPv4AddressRangeTable<T>::fillLevel1(uint32_t first,
+                                          uint32_t count,
+                                          uint32_t entry)
+{
+    std::fill(_level1.begin() + first, _level1.begin() + first + count, entry);
+}
+
+
+template<typename T>
+uint32_t IPv4AddressRangeTable<T>::toHostOrder(uint32_t address)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&address);
+
+    return (uint32_t(bytes[0]) << 24)
+         | (uint32_t(bytes[1]) << 16)
+         | (uint32_t(bytes[2]) << 8)
+         |  uint32_t(bytes[3]);
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <utility>
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief An unbounded, lock-free, single-producer single-consumer queue.
+///
+/// One thread may push() while another thread pops. Neither side ever waits
+/// for the other. Each push allocates one node, so the queue suits event
+/// streams rather than bulk data.
+///
+/// \tparam T A default-constructible, movable value type.
+template<typename T>
+class LockFreeQueue
+{
+public:
+    LockFreeQueue();
+    ~LockFreeQueue();
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator = (const LockFreeQueue&) = delete;
+
+    /// \brief Add a value. Only call from the producer thread.
+    /// \param value The value.
+    void push(T value);
+
+    /// \brief Remove the oldest value. Only call from the consumer thread.
+    /// \param value Receives the value if there is one.
+    /// \returns true iff a value was removed.
+    bool pop(T& value);
+
+    /// \returns true iff the queue is empty. Only call from the consumer
+    ///          thread.
+    bool empty() const;
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next;
+        T value;
+
+        Node(): next(nullptr)
+        {
+        }
+    };
+
+    /// \brief The most recently pushed node, owned by the producer.
+    Node* _head;
+
+    /// \brief The consumed node before the oldest value, owned by the
+    ///        consumer.
+    Node* _tail;
+
+};
+
+
+template<typename T>
+LockFreeQueue<T>::LockFreeQueue():
+    _head(new Node()),
+    _tail(_head)
+{
+}
+
+
+template<typename T>
+LockFreeQueue<T>::~LockFreeQueue()
+{
+    while (_tail)
+    {
+        Node* next = _tail->next.load(std::memory_order_relaxed);
+        delete _tail;
+        _tail = next;
+    }
+}
+
+
+template<typename T>
+void LockFreeQueue<T>::push(T value)
+{
+    Node* node = new Node();
+    node->value = std::move(value);
+    _head->next.store(node, std::memory_order_release);
+    _head = node;
+}
+
+
+template<typename T>
+bool LockFreeQueue<T>::pop(T& value)
+{
+    Node* next = _tail->next.load(std::memory_order_acquire);
+
+    if (!next)
+        return false;
+
+    value = std::move(next->value);
+    delete _tail;
+    _tail = next;
+    return true;
+}
+
+
+template<typename T>
+bool LockFreeQueue<T>::empty() const
+{
+    return _tail->next.load(std::memory_order_acquire) == nullptr;
+}
+
+
+} } // namespace ofx::Net
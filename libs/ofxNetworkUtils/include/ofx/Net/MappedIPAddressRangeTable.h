@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Poco/Net/IPAddress.h"
+#include "ofConstants.h"
+#include "ofx/Net/CompactIPAddressRange.h"
+#include "ofx/Net/IPAddressRange.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A read-only longest-prefix-match table stored in a memory-mapped file.
+///
+/// A table is compiled once from an IPAddressRange::List with write() and
+/// opened by any number of processes with open(). The file is mapped
+/// read-only and queried in place, so opening a table costs one mmap() call
+/// regardless of its size and all processes on a host share the same
+/// page-cache copy.
+///
+/// The ranges are flattened into sorted, non-overlapping address intervals.
+/// Each interval refers to the most specific range that covers it, so a
+/// lookup is a single binary search per family.
+///
+/// The file layout is:
+///
+///     Header
+///     Entry[entryCount]
+///     uint32_t IPv4 interval starts[ipv4Count]
+///     uint32_t IPv4 interval entry indices[ipv4Count]
+///     IPAddressBits IPv6 interval starts[ipv6Count]
+///     uint32_t IPv6 interval entry indices[ipv6Count]
+///
+/// All sections are 64-byte aligned and stored in host byte order. Files
+/// written with a different version or byte order are rejected by open().
+class MappedIPAddressRangeTable
+{
+public:
+    /// \brief A stored range and its payload.
+    struct Entry
+    {
+        /// \brief The range as written.
+        CompactIPAddressRange range;
+
+        /// \brief Reserved, always zero.
+        uint16_t reserved;
+
+        /// \brief The user payload.
+        uint32_t value;
+    };
+
+    /// \brief The file header.
+    struct Header
+    {
+        /// \brief The file signature, "OFXNPTB" followed by a zero byte.
+        char magic[8];
+
+        /// \brief The file format version.
+        uint32_t version;
+
+        /// \brief BYTE_ORDER_MARK as written by the producing host.
+        uint32_t byteOrder;
+
+        /// \brief The total file size in bytes.
+        uint64_t fileSize;
+
+        /// \brief The number of entries.
+        uint64_t entryCount;
+
+        /// \brief The byte offset of the entries.
+        uint64_t entryOffset;
+
+        /// \brief The number of IPv4 intervals.
+        uint64_t ipv4Count;
+
+        /// \brief The byte offset of the IPv4 interval starts.
+        uint64_t ipv4StartOffset;
+
+        /// \brief The byte offset of the IPv4 interval entry indices.
+        uint64_t ipv4IndexOffset;
+
+        /// \brief The number of IPv6 intervals.
+        uint64_t ipv6Count;
+
+        /// \brief The byte offset of the IPv6 interval starts.
+        uint64_t ipv6StartOffset;
+
+        /// \brief The byte offset of the IPv6 interval entry indices.
+        uint64_t ipv6IndexOffset;
+    };
+
+    enum
+    {
+        /// \brief The current file format version.
+        VERSION = 1,
+
+        /// \brief The value used to detect a byte order mismatch.
+        BYTE_ORDER_MARK = 0x01020304,
+
+        /// \brief An interval index that refers to no entry.
+        NONE = 0xFFFFFFFF
+    };
+
+    /// \brief Create a closed table.
+    MappedIPAddressRangeTable();
+
+    /// \brief Unmap the table.
+    ~MappedIPAddressRangeTable();
+
+    MappedIPAddressRangeTable(const MappedIPAddressRangeTable&) = delete;
+    MappedIPAddressRangeTable& operator = (const MappedIPAddressRangeTable&) = delete;
+
+    /// \brief Map a table file.
+    ///
+    /// Any previously opened table is closed first. The path is resolved
+    /// with ofToDataPath().
+    ///
+    /// \param path The file path.
+    /// \returns true iff the file was mapped and its header is valid.
+    bool open(const std::string& path);
+
+    /// \brief Unmap the table.
+    ///
+    /// All pointers returned by find() are invalidated.
+    void close();
+
+    /// \returns true iff a table is mapped.
+    bool isOpen() const;
+
+    /// \brief Find the most specific range containing an address.
+    /// \param address The address to look up.
+    /// \returns the matching entry or nullptr if there is no match.
+    const Entry* find(const CompactIPAddress& address) const;
+
+    /// \brief Find the most specific range containing an address.
+    /// \param address The address to look up.
+    /// \returns the matching entry or nullptr if there is no match.
+    const Entry* find(const Poco::Net::IPAddress& address) const;
+
+    /// \returns the stored entries, sorted by family, subnet and prefix.
+    const Entry* entries() const;
+
+    /// \returns the number of stored entries.
+    std::size_t size() const;
+
+    /// \returns true iff no entries are stored.
+    bool empty() const;
+
+    /// \brief Compile ranges into a table file.
+    ///
+    /// The payload of each range is its index in ranges. If a range with the
+    /// same subnet and prefix appears more than once, the last one is kept.
+    ///
+    /// The file is written to a uniquely named temporary file, flushed to
+    /// disk and renamed into place. Processes that already have the old file
+    /// mapped are not affected, concurrent writers do not collide, and a
+    /// crash leaves either the old table or the complete new one.
+    ///
+    /// \param path The file path, resolved with ofToDataPath().
+    /// \param ranges The ranges to store.
+    /// \returns true iff the file was written.
+    static bool write(const std::string& path,
+                      const IPAddressRange::List& ranges);
+
+    /// \brief Compile ranges with one payload per range into a table file.
+    /// \param path The file path, resolved with ofToDataPath().
+    /// \param ranges The ranges to store.
+    /// \param values The payloads, in the same order as the ranges.
+    /// \returns true iff the file was written.
+    static bool write(const std::string& path,
+                      const IPAddressRange::List& ranges,
+                      const std::vector<uint32_t>& values);
+
+private:
+    /// \brief Check a mapped header and set up the section pointers.
+    /// \returns true iff the header is valid.
+    bool load();
+
+    /// \brief The mapped file, or nullptr if closed.
+    const uint8_t* _data;
+
+    /// \brief The mapped length in bytes.
+    std::size_t _length;
+
+    /// \brief The entries.
+    const Entry* _entries;
+
+    /// \brief The number of entries.
+    std::size_t _entryCount;
+
+    /// \brief The IPv4 interval starts as numeric values.
+    const uint32_t* _ipv4Starts;
+
+    /// \brief The entry index of each IPv4 interval.
+    const uint32_t* _ipv4Indices;
+
+    /// \brief The number of IPv4 intervals.
+    std::size_t _ipv4Count;
+
+    /// \brief The IPv6 interval starts as left-aligned address bits.
+    const IPAddressBits* _ipv6Starts;
+
+    /// \brief The entry index of each IPv6 interval.
+    const uint32_t* _ipv6Indices;
+
+    /// \brief The number of IPv6 intervals.
+    std::size_t _ipv6Count;
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <vector>
+#include "Poco/Net/NetworkInterface.h"
+#include "ofx/Net/NetworkInterfaceInfo.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief Enumerate the network interfaces and their addresses.
+///
+/// The POCO backend converts Poco::Net::NetworkInterface::map() and works on
+/// every platform. The NETLINK backend is Linux only. It asks the kernel for
+/// one RTM_GETLINK dump and one RTM_GETADDR dump over a netlink socket and
+/// builds the list directly. It skips the per-interface ioctl calls the
+/// portable path makes, which matters on hosts with hundreds of interfaces.
+///
+/// Both backends list the interfaces that are up and have at least one IP
+/// address, in index order, like NetworkInterface::map(). The socket and receive buffer
+/// are kept between calls, so reuse one enumerator for repeated calls. An
+/// enumerator is not synchronized.
+class NetworkInterfaceEnumerator
+{
+public:
+    /// \brief The enumeration backend.
+    enum Backend
+    {
+        /// \brief NETLINK where available, otherwise POCO.
+        AUTOMATIC,
+        /// \brief Poco::Net::NetworkInterface::map().
+        POCO,
+        /// \brief Linux netlink dumps.
+        NETLINK
+    };
+
+    /// \brief Create an enumerator.
+    /// \param backend The backend to use.
+    explicit NetworkInterfaceEnumerator(Backend backend = AUTOMATIC);
+
+    /// \brief Close the netlink socket, if any.
+    ~NetworkInterfaceEnumerator();
+
+    NetworkInterfaceEnumerator(const NetworkInterfaceEnumerator&) = delete;
+    NetworkInterfaceEnumerator& operator = (const NetworkInterfaceEnumerator&) = delete;
+
+    /// \brief Enumerate the interfaces.
+    ///
+    /// If the NETLINK backend fails, the POCO backend is used instead.
+    ///
+    /// \param interfaces The interfaces, replacing the previous contents.
+    /// \returns true iff the enumeration succeeded.
+    bool enumerate(NetworkInterfaceInfo::List& interfaces);
+
+    /// \returns the backend used by enumerate().
+    Backend backend() const;
+
+    /// \returns the backend that produced the result of the last
+    ///          enumerate(), which is POCO if NETLINK failed over, or
+    ///          AUTOMATIC if nothing has been enumerated.
+    Backend lastBackend() const;
+
+    /// \param backend A backend.
+    /// \returns true iff the backend is available on this platform.
+    static bool isAvailable(Backend backend);
+
+    /// \brief Convert a Poco interface.
+    /// \param networkInterface The interface.
+    /// \returns the description.
+    static NetworkInterfaceInfo fromPoco(const Poco::Net::NetworkInterface& networkInterface);
+
+private:
+    /// \brief Enumerate with Poco::Net::NetworkInterface::map().
+    bool enumeratePoco(NetworkInterfaceInfo::List& interfaces);
+
+    /// \brief Enumerate with netlink dumps.
+    bool enumerateNetlink(NetworkInterfaceInfo::List& interfaces);
+
+    /// \brief Send a dump request and pass each reply message to a handler.
+    /// \returns true iff the dump completed.
+    template<typename Handler>
+    bool dump(uint16_t type, Handler handler);
+
+    /// \brief The selected backend.
+    Backend _backend;
+
+    /// \brief The backend of the last enumeration.
+    Backend _lastBackend;
+
+    /// \brief The netlink socket, or -1.
+    int _socket;
+
+    /// \brief The last netlink request sequence number.
+    uint32_t _sequence;
+
+    /// \brief The netlink receive buffer.
+    std::vector<char> _buffer;
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include "Poco/Net/NetworkInterface.h"
+#include "ofx/Net/NetworkInterfaceInfo.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief One change detected by a NetworkInterfaceListener.
+struct NetworkInterfaceEvent
+{
+    /// \brief The kind of change.
+    enum Type
+    {
+        /// \brief The interface appeared.
+        INTERFACE_UP,
+        /// \brief The interface disappeared.
+        INTERFACE_DOWN,
+        /// \brief An address was assigned to the interface.
+        ADDRESS_ADDED,
+        /// \brief An address was removed from the interface.
+        ADDRESS_REMOVED,
+        /// \brief The up, running, loopback, point-to-point, broadcast or
+        ///        multicast flags changed.
+        FLAGS_CHANGED,
+        /// \brief The maximum transmission unit changed.
+        MTU_CHANGED,
+        /// \brief The hardware address changed.
+        MAC_ADDRESS_CHANGED
+    };
+
+    /// \brief The kind of change.
+    Type type = INTERFACE_UP;
+
+    /// \brief The interface index as a Poco interface. Only set for
+    ///        INTERFACE_UP and INTERFACE_DOWN. The other fields are not
+    ///        enumerated; use info, or listen to onInterfaceUp and
+    ///        onInterfaceDown for the full Poco interface.
+    Poco::Net::NetworkInterface interface;
+
+    /// \brief The interface after the change, or the last known state for
+    ///        INTERFACE_DOWN.
+    NetworkInterfaceInfo info;
+
+    /// \brief The interface before the change. Empty for INTERFACE_UP.
+    NetworkInterfaceInfo previousInfo;
+
+    /// \brief The address, for ADDRESS_ADDED and ADDRESS_REMOVED.
+    NetworkInterfaceInfo::AddressInfo address;
+};
+
+
+} } // namespace ofx::Net
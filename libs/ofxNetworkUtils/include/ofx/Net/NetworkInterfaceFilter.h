@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ofx/Net/CompactIPAddress.h"
+#include "ofx/Net/CompactIPAddressRange.h"
+#include "ofx/Net/IPAddressRange.h"
+#include "ofx/Net/NetworkInterfaceEvent.h"
+#include "ofx/Net/NetworkInterfaceQuery.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A declarative test on NetworkInterfaceEvent objects.
+///
+/// Each criterion is optional and an event matches if it meets every
+/// criterion that is set:
+///
+///     NetworkInterfaceFilter filter;
+///     filter.setName("eth*")
+///           .setFamilies(NetworkInterfaceQuery::IPV4)
+///           .addRange(IPAddressRange("10.0.0.0/8"));
+///
+/// The criteria are compiled when they are set. A name pattern without
+/// wildcards is an exact comparison and a pattern with a single trailing *
+/// is a prefix comparison. Ranges are stored in compact form.
+///
+/// Family and range criteria test the event's address for ADDRESS_ADDED and
+/// ADDRESS_REMOVED events and any address of the interface otherwise.
+class NetworkInterfaceFilter
+{
+public:
+    /// \brief The properties of one event that filters test.
+    ///
+    /// Computed once per event and shared by every filter tested against it.
+    struct Candidate
+    {
+        /// \brief Describe an event.
+        /// \param event The event, which must outlive the candidate.
+        explicit Candidate(const NetworkInterfaceEvent& event);
+
+        /// \brief The event.
+        const NetworkInterfaceEvent& event;
+
+        /// \brief The NetworkInterfaceQuery::Families flags of the addresses.
+        uint32_t families;
+
+        /// \brief The addresses tested by family and range criteria.
+        std::vector<CompactIPAddress> addresses;
+    };
+
+    enum
+    {
+        /// \brief Every NetworkInterfaceEvent::Type.
+        ALL_EVENT_TYPES = 0xFFFFFFFF
+    };
+
+    /// \brief Create a filter that matches every event.
+    NetworkInterfaceFilter();
+
+    /// \brief Match events of the given types.
+    /// \param eventTypes A combination of eventTypeFlag() values.
+    /// \returns this filter.
+    NetworkInterfaceFilter& setEventTypes(uint32_t eventTypes);
+
+    /// \brief Match interfaces whose name matches a glob pattern.
+    ///
+    /// * matches any run of characters and ? matches any one character. An
+    /// empty pattern matches every name.
+    ///
+    /// \param pattern The pattern.
+    /// \returns this filter.
+    NetworkInterfaceFilter& setName(const std::string& pattern);
+
+    /// \brief Match one interface index.
+    /// \param index The index.
+    /// \returns this filter.
+    NetworkInterfaceFilter& setIndex(unsigned index);
+
+    /// \brief Match any interface index.
+    /// \returns this filter.
+    NetworkInterfaceFilter& clearIndex();
+
+    /// \brief Match addresses of the given families.
+    /// \param families A combination of NetworkInterfaceQuery::Families flags.
+    /// \returns this filter.
+    NetworkInterfaceFilter& setFamilies(uint32_t families);
+
+    /// \brief Match addresses inside a range.
+    ///
+    /// If any ranges are added, an address must be inside at least one.
+    ///
+    /// \param range The range.
+    /// \returns this filter.
+    NetworkInterfaceFilter& addRange(const IPAddressRange& range);
+
+    /// \brief Remove all ranges.
+    /// \returns this filter.
+    NetworkInterfaceFilter& clearRanges();
+
+    /// \param candidate A described event.
+    /// \returns true iff the event meets every criterion.
+    bool matches(const Candidate& candidate) const;
+
+    /// \param event An event.
+    /// \returns true iff the event meets every criterion.
+    bool matches(const NetworkInterfaceEvent& event) const;
+
+    /// \param type An event type.
+    /// \returns the flag of the event type for setEventTypes().
+    static uint32_t eventTypeFlag(NetworkInterfaceEvent::Type type);
+
+private:
+    /// \brief How the name pattern is compared.
+    enum NameMatch
+    {
+        ANY_NAME,
+        EXACT_NAME,
+        PREFIX_NAME,
+        GLOB_NAME
+    };
+
+    /// \returns true iff a name matches a glob pattern.
+    static bool glob(const std::string& pattern, const std::string& name);
+
+    uint32_t _eventTypes;
+    NameMatch _nameMatch;
+    std::string _name;
+    bool _hasIndex;
+    unsigned _index;
+    uint32_t _families;
+    std::vector<CompactIPAddressRange> _ranges;
+
+};
+
+
+} } // namespace ofx::Net
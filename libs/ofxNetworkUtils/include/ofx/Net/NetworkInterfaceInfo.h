@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include "Poco/Net/IPAddress.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A plain description of a network interface and its addresses.
+///
+/// Unlike Poco::Net::NetworkInterface, every field can be filled in directly,
+/// so it can be built from any enumeration backend.
+struct NetworkInterfaceInfo
+{
+    typedef std::vector<NetworkInterfaceInfo> List;
+
+    /// \brief One address assigned to an interface.
+    struct AddressInfo
+    {
+        /// \brief The address. IPv6 link-local addresses carry the scope.
+        Poco::Net::IPAddress address;
+
+        /// \brief The subnet mask.
+        Poco::Net::IPAddress subnetMask;
+
+        /// \brief The broadcast address, or the peer address of a
+        ///        point-to-point interface. Wildcard if there is none.
+        Poco::Net::IPAddress broadcastAddress;
+    };
+
+    /// \brief The interface index.
+    unsigned index = 0;
+
+    /// \brief The interface name.
+    std::string name;
+
+    /// \brief The hardware address. Empty if there is none.
+    std::vector<unsigned char> macAddress;
+
+    /// \brief The maximum transmission unit, or 0 if unknown.
+    unsigned mtu = 0;
+
+    /// \brief True iff the interface is administratively up.
+    bool isUp = false;
+
+    /// \brief True iff the interface is up and has a carrier.
+    bool isRunning = false;
+
+    /// \brief True iff this is a loopback interface.
+    bool isLoopback = false;
+
+    /// \brief True iff this is a point-to-point interface.
+    bool isPointToPoint = false;
+
+    /// \brief True iff the interface supports broadcast.
+    bool supportsBroadcast = false;
+
+    /// \brief True iff the interface supports multicast.
+    bool supportsMulticast = false;
+
+    /// \brief The assigned addresses.
+    std::vector<AddressInfo> addresses;
+};
+
+
+} } // namespace ofx::Net
@@ -8,28 +8,270 @@
 #pragma once
 
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "ofEvents.h"
 #include "Poco/Net/NetworkInterface.h"
+#include "ofx/Net/LockFreeQueue.h"
+#include "ofx/Net/NetworkInterfaceEvent.h"
+#include "ofx/Net/NetworkInterfaceFilter.h"
+#include "ofx/Net/NetworkInterfaceSnapshot.h"
+#include "ofx/Net/NetworkInterfaceSource.h"
 
 
 namespace ofx {
 namespace Net {
 
 
+/// \brief Raise events when network interfaces come up, go down or change.
+///
+/// Each interface is compared by a fingerprint of its flags, MTU, hardware
+/// address and addresses (see NetworkInterfaceSnapshot::fingerprint()), so
+/// interfaces that did not change cost one integer comparison. Changed
+/// interfaces raise one typed event per difference.
+///
+/// With the NOTIFICATION backend the listener follows the shared
+/// NetworkInterfaceSnapshot, which the operating system marks stale when a
+/// link or address changes (see NetworkInterfaceSnapshot::isWatching()).
+/// An update() without a change costs one atomic load, and the interfaces
+/// are only enumerated and compared after the kernel reports a change.
+///
+/// With the POLLING backend the interfaces are enumerated and compared every
+/// poll interval.
+///
+/// Snapshots come from NetworkInterfaceSource::system() unless another
+/// source is given, such as a SyntheticNetworkInterfaceSource for tests and
+/// benchmarks.
+///
+/// With MAIN_THREAD threading, changes are detected and delivered inside
+/// update(). With BACKGROUND_THREAD threading, a worker thread started by the
+/// first update() detects them and hands each batch of events to update()
+/// through a lock-free queue, so the main thread only pays to dequeue.
+/// Subscribers that want events as soon as they are detected can listen to
+/// onChangeImmediate instead, which is raised on the worker thread.
+///
+/// With MANUAL threading the listener does not use ofEvents().update, so it
+/// can run in a headless program with its own event loop. fd() becomes
+/// readable when there may be changes to deliver, and process() detects and
+/// delivers them:
+///
+///     NetworkInterfaceListener listener(NetworkInterfaceListener::AUTOMATIC,
+///                                       NetworkInterfaceListener::MANUAL);
+///
+///     pollfd descriptor = { listener.fd(), POLLIN, 0 };
+///
+///     while (running)
+///     {
+///         ::poll(&descriptor, 1, listener.timeout());
+///         listener.process();
+///     }
+///
+/// On Linux the descriptor also becomes readable when the next poll or
+/// damping deadline is due, so timeout() may be ignored. On other platforms
+/// the descriptor only reports change notifications, or is -1 on Windows,
+/// and timeout() must be honored.
+///
+/// Damping is off by default. When a quiet window is set, the changes to an
+/// interface are held until it has been quiet for the window, then reduced
+/// to the net transition. An interface that goes down and comes back up in
+/// the same state raises nothing. An interface that keeps flapping has its
+/// window doubled up to a maximum, which suppresses it until it settles.
+///
+/// subscribe() delivers only the events that match a NetworkInterfaceFilter:
+///
+///     NetworkInterfaceFilter filter;
+///     filter.setName("wlan*").addRange(IPAddressRange("192.168.0.0/16"));
+///
+///     listener.subscribe(filter, [](const NetworkInterfaceEvent& event) {
+///         ofLogNotice() << event.info.name << " changed";
+///     });
+///
+/// The properties of each event are extracted once and tested against every
+/// filter, so subscribers that are not interested cost a few comparisons
+/// rather than a call.
 class NetworkInterfaceListener
 {
 public:
-    NetworkInterfaceListener();
+    /// \brief The change detection backend.
+    enum Backend
+    {
+        /// \brief NOTIFICATION where available, otherwise POLLING.
+        AUTOMATIC,
+        /// \brief Enumerate every poll interval.
+        POLLING,
+        /// \brief Enumerate only when the operating system reports a change.
+        NOTIFICATION
+    };
+
+    /// \brief The thread that detects changes.
+    enum Threading
+    {
+        /// \brief Detect changes in update() on the main thread.
+        MAIN_THREAD,
+        /// \brief Detect changes on a dedicated worker thread.
+        BACKGROUND_THREAD,
+        /// \brief Detect changes in process(), called by the application.
+        MANUAL
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    /// \brief A subscriber function.
+    typedef std::function<void(const NetworkInterfaceEvent&)> Handler;
+
+    /// \brief Flap damping settings.
+    struct DampingSettings
+    {
+        /// \brief How long an interface must be quiet before its changes are
+        ///        delivered. Zero disables damping.
+        std::chrono::milliseconds quietWindow = std::chrono::milliseconds(0);
+
+        /// \brief The number of changes within one window that doubles the
+        ///        window for that interface.
+        unsigned flapThreshold = 3;
+
+        /// \brief The longest window. An interface that has been quiet for
+        ///        twice its window starts again from quietWindow.
+        std::chrono::milliseconds maximumWindow = std::chrono::milliseconds(60000);
+    };
+
+    /// \brief Event counters.
+    struct Statistics
+    {
+        /// \brief Events found by comparing consecutive snapshots.
+        uint64_t rawEvents = 0;
+
+        /// \brief Events delivered after damping.
+        uint64_t deliveredEvents = 0;
+
+        /// \brief The number of times a flapping interface's window was
+        ///        doubled.
+        uint64_t suppressions = 0;
+    };
+
+    /// \brief Create a listener.
+    ///
+    /// Unless threading is MANUAL, the listener is driven by
+    /// ofEvents().update.
+    ///
+    /// \param backend The change detection backend.
+    /// \param threading The thread that detects changes.
+    NetworkInterfaceListener(Backend backend = AUTOMATIC,
+                             Threading threading = MAIN_THREAD);
+
+    /// \brief Create a listener that reads snapshots from a source.
+    /// \param source The source, e.g. a SyntheticNetworkInterfaceSource.
+    /// \param backend The change detection backend.
+    /// \param threading The thread that detects changes.
+    NetworkInterfaceListener(std::shared_ptr<NetworkInterfaceSource> source,
+                             Backend backend = AUTOMATIC,
+                             Threading threading = MAIN_THREAD);
     ~NetworkInterfaceListener();
 
     void update(ofEventArgs& args);
 
-    /// \returns the last known interface map.
+    /// \brief Detect and deliver changes with MANUAL threading.
+    ///
+    /// Call when fd() is readable or timeout() has passed. Calling it at
+    /// other times is harmless. Never blocks.
+    void process();
+
+    /// \returns a descriptor that becomes readable when process() should be
+    ///          called, or -1 if there is none. Only valid with MANUAL
+    ///          threading.
+    int fd() const;
+
+    /// \returns the milliseconds until process() should be called even if
+    ///          fd() is not readable, or -1 if there is no deadline. If fd()
+    ///          is -1 this is never more than the update interval. Suitable
+    ///          for poll() and epoll_wait().
+    int timeout() const;
+
+    /// \returns the last known interface map, as of the last delivered events.
+    ///          The map is enumerated on the first call for each snapshot.
     const Poco::Net::NetworkInterface::Map& interfaces() const;
 
+    /// \returns the source of the snapshots.
+    std::shared_ptr<NetworkInterfaceSource> source() const;
+
+    /// \returns the backend in use.
+    Backend backend() const;
+
+    /// \returns the thread that detects changes.
+    Threading threading() const;
+
+    /// \brief Set the interval of the POLLING backend.
+    /// \param interval The interval in milliseconds.
+    void setPollInterval(uint64_t interval);
+
+    /// \returns the interval of the POLLING backend in milliseconds.
+    uint64_t getPollInterval() const;
+
+    /// \brief Set the flap damping settings.
+    ///
+    /// Changes already being held keep their current window.
+    ///
+    /// \param settings The settings.
+    void setDamping(const DampingSettings& settings);
+
+    /// \returns the flap damping settings.
+    DampingSettings getDamping() const;
+
+    /// \returns the event counters.
+    Statistics statistics() const;
+
+    /// \brief Call a function in update() for each event that matches a filter.
+    ///
+    /// Handlers are called after onChange, in the order they subscribed. A
+    /// handler may subscribe or unsubscribe; the change takes effect with the
+    /// next batch of changes.
+    ///
+    /// \param filter The filter, which is copied.
+    /// \param handler The function to call.
+    /// \returns the subscription id for unsubscribe().
+    std::size_t subscribe(const NetworkInterfaceFilter& filter, Handler handler);
+
+    /// \brief Remove a subscription.
+    /// \param id The id returned by subscribe().
+    void unsubscribe(std::size_t id);
+
+    /// \brief Raised in update() or process() when an interface appears.
+    ///
+    /// The Poco interface list is only enumerated when this has listeners.
     ofEvent<const Poco::Net::NetworkInterface> onInterfaceUp;
+
+    /// \brief Raised in update() or process() when an interface disappears.
     ofEvent<const Poco::Net::NetworkInterface> onInterfaceDown;
 
+    /// \brief Raised in update() or process() when an address is assigned.
+    ofEvent<const NetworkInterfaceEvent> onAddressAdded;
+
+    /// \brief Raised in update() or process() when an address is removed.
+    ofEvent<const NetworkInterfaceEvent> onAddressRemoved;
+
+    /// \brief Raised in update() or process() when the interface flags change.
+    ofEvent<const NetworkInterfaceEvent> onFlagsChanged;
+
+    /// \brief Raised in update() or process() when the MTU changes.
+    ofEvent<const NetworkInterfaceEvent> onMTUChanged;
+
+    /// \brief Raised in update() or process() when the hardware address changes.
+    ofEvent<const NetworkInterfaceEvent> onMACAddressChanged;
+
+    /// \brief Raised in update() or process() for every change, in order.
+    ofEvent<const NetworkInterfaceEvent> onChange;
+
+    /// \brief Raised for every change on the thread that detected it, before
+    ///        it is queued for update().
+    ofEvent<const NetworkInterfaceEvent> onChangeImmediate;
+
     enum
     {
         /// \brief The default polling interval in milliseconds.
@@ -38,12 +280,187 @@ public:
 
 
 private:
+    /// \brief The events found in one snapshot.
+    struct Batch
+    {
+        /// \brief The snapshot the events lead to.
+        std::shared_ptr<const NetworkInterfaceSnapshot> snapshot;
+
+        /// \brief The events, in order.
+        std::vector<NetworkInterfaceEvent> events;
+    };
+
+    /// \brief A filtered subscriber.
+    struct Subscription
+    {
+        std::size_t id;
+        NetworkInterfaceFilter filter;
+        Handler handler;
+    };
+
+    typedef std::vector<Subscription> Subscriptions;
+
+    /// \brief The damping state of one interface.
+    struct DampingRecord
+    {
+        /// \brief True while changes are being held.
+        bool pending = false;
+
+        /// \brief The last delivered state, if the interface was present.
+        bool baselinePresent = false;
+        NetworkInterfaceInfo baseline;
+
+        /// \brief The latest state, if the interface is present.
+        bool latestPresent = false;
+        NetworkInterfaceInfo latest;
+
+        /// \brief The current window.
+        std::chrono::milliseconds window = std::chrono::milliseconds(0);
+
+        /// \brief The changes seen in the current window.
+        unsigned changes = 0;
+
+        /// \brief The time of the last change.
+        Clock::time_point lastChange;
+
+        /// \brief When the held changes are delivered.
+        Clock::time_point deadline;
+    };
+
+    /// \brief Compare a snapshot to the last one, apply damping, collect the
+    ///        events that are due and raise onChangeImmediate.
+    /// \param snapshot The snapshot.
+    /// \param batch Receives the snapshot and its events.
+    /// \returns true iff the snapshot was new or events are due.
+    bool detect(std::shared_ptr<const NetworkInterfaceSnapshot> snapshot,
+                Batch& batch);
+
+    /// \brief Collect the events between two states of one interface.
+    /// \param previous The earlier state, or nullptr if it was absent.
+    /// \param current The later state, or nullptr if it is absent.
+    /// \param events Receives the events.
+    static void transition(const NetworkInterfaceInfo* previous,
+                           const NetworkInterfaceInfo* current,
+                           std::vector<NetworkInterfaceEvent>& events);
+
+    /// \brief Enumerate the Poco interface for an INTERFACE_UP or
+    ///        INTERFACE_DOWN event.
+    /// \param event The event.
+    /// \param snapshot The snapshot the event was detected in.
+    /// \returns the enumerated interface, or event.interface if it is gone.
+    static Poco::Net::NetworkInterface pocoInterface(const NetworkInterfaceEvent& event,
+                                                     const NetworkInterfaceSnapshot& snapshot);
+
+    /// \brief Collect the events for an interface whose fingerprint changed.
+    static void compare(const NetworkInterfaceInfo& previous,
+                        const NetworkInterfaceInfo& current,
+                        std::vector<NetworkInterfaceEvent>& events);
+
+    /// \brief Hold raw events until their interfaces are quiet.
+    void damp(const std::vector<NetworkInterfaceEvent>& events,
+              const DampingSettings& settings,
+              Clock::time_point now);
+
+    /// \brief Collect the net events of interfaces whose window has passed.
+    /// \param now The current time.
+    /// \param events Receives the events.
+    /// \param all True to collect every held change, e.g. once damping is
+    ///        turned off.
+    void flush(Clock::time_point now,
+               std::vector<NetworkInterfaceEvent>& events,
+               bool all = false);
+
+    /// \brief Raise the main thread events for a batch.
+    void deliver(const Batch& batch);
+
+    /// \brief The worker thread function.
+    void run();
+
+    /// \brief Make fd() readable.
+    void signal();
+
+    /// \brief Consume the readiness of fd() and rearm its timer.
+    void drain();
+
+    /// \returns when process() is next due without a change notification.
+    Clock::time_point nextWake() const;
+
     ofEventListener _updateListener;
 
+    std::shared_ptr<NetworkInterfaceSource> _source;
+
+    Backend _backend;
+    Threading _threading;
+
     uint64_t _lastUpdate = 0;
-    uint64_t _updateInterval = DEFAULT_POLL_INTERVAL;
+    std::atomic<uint64_t> _updateInterval;
+
+    /// \brief The last snapshot compared by detect(), owned by the
+    ///        detecting thread.
+    std::shared_ptr<const NetworkInterfaceSnapshot> _detected;
+
+    /// \brief The snapshot of the last delivered batch, owned by the main
+    ///        thread.
+    std::shared_ptr<const NetworkInterfaceSnapshot> _snapshot;
+
+    /// \brief Batches from the worker thread to update().
+    LockFreeQueue<Batch> _queue;
+
+    /// \brief The worker thread.
+    std::thread _thread;
+
+    /// \brief Guards _changed, _stopping, _dampingSettings and
+    ///        _subscriptions.
+    mutable std::mutex _mutex;
+
+    /// \brief Wakes the worker thread.
+    std::condition_variable _condition;
+
+    /// \brief True when the snapshot has been marked stale.
+    bool _changed = true;
+
+    /// \brief True when the worker thread should exit.
+    bool _stopping = false;
+
+    /// \brief When the POLLING backend next enumerates with MANUAL threading.
+    Clock::time_point _nextPoll;
+
+    /// \brief The descriptor returned by fd(), or -1.
+    int _fd = -1;
+
+    /// \brief The descriptor written by signal(), or -1.
+    int _signalFd = -1;
+
+    /// \brief The descriptor read by drain(), or -1.
+    int _drainFd = -1;
+
+    /// \brief The deadline timer, or -1.
+    int _timerFd = -1;
+
+    /// \brief The snapshot change callback id, or 0.
+    std::size_t _callbackId = 0;
+
+    /// \brief The damping settings, guarded by _mutex.
+    DampingSettings _dampingSettings;
+
+    /// \brief The damping state by interface index, owned by the detecting
+    ///        thread.
+    std::map<unsigned, DampingRecord> _damping;
+
+    /// \brief The earliest deadline in _damping, owned by the detecting
+    ///        thread.
+    Clock::time_point _nextDeadline = Clock::time_point::max();
+
+    /// \brief The subscriptions. Replaced rather than modified, so update()
+    ///        can dispatch from a copy of the pointer without holding _mutex.
+    std::shared_ptr<const Subscriptions> _subscriptions;
+
+    /// \brief The last subscription id.
+    std::size_t _lastSubscriptionId = 0;
 
-    Poco::Net::NetworkInterface::Map _interfaces;
+    std::atomic<uint64_t> _rawEvents;
+    std::atomic<uint64_t> _deliveredEvents;
+    std::atomic<uint64_t> _suppressions;
 
 };
 
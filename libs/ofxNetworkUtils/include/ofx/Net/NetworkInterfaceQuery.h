@@ -0,0 +1,216 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include "Poco/Net/IPAddress.h"
+#include "ofx/Net/CompactIPAddressRange.h"
+#include "ofx/Net/IPAddressRange.h"
+#include "ofx/Net/NetworkInterfaceSnapshot.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief Select interface addresses by any combination of criteria.
+///
+/// A query matches one interface address at a time. Each criterion is a set
+/// of flags, and an address matches a criterion if it has any of the flags.
+/// An address matches the query if it matches every criterion:
+///
+///     NetworkInterfaceQuery query;
+///     query.setAddressTypes(NetworkInterfaceQuery::SITE_LOCAL | NetworkInterfaceQuery::LINK_LOCAL)
+///          .setFamilies(NetworkInterfaceQuery::IPV4)
+///          .setStates(NetworkInterfaceQuery::UP);
+///
+///     for (const NetworkInterfaceSnapshot::Address& address: query.run())
+///         ofLogNotice() << address.interface->name << " " << address.address.toString();
+///
+/// waitFor() blocks until a query matches, e.g. until an interface with an
+/// address in a given range comes up:
+///
+///     NetworkInterfaceQuery query;
+///     query.addRange(IPAddressRange("192.168.1.0/24")).setStates(NetworkInterfaceQuery::UP);
+///
+///     auto result = query.waitFor(std::chrono::seconds(30));
+///
+/// Queries run against a NetworkInterfaceSnapshot, whose addresses are
+/// classified once when the snapshot is built. Running a query is a single
+/// pass of flag tests and returns references into the snapshot rather than
+/// copies of the interfaces.
+class NetworkInterfaceQuery
+{
+public:
+    /// \brief Address type flags. The flag-set form of NetworkUtils::AddressType.
+    enum AddressTypes
+    {
+        /// \brief Wildcard address (e.g. all zeros)
+        WILDCARD = 1 << 0,
+        /// \brief Broadcast address (e.g. all bits are 1)
+        BROADCAST = 1 << 1,
+        /// \brief Loopback address (e.g. 127.0.0.1 / ::1)
+        LOOPBACK = 1 << 2,
+        /// \brief Multicast address (e.g. 224.0.0.0 to 239.255.255.255 range)
+        MULTICAST = 1 << 3,
+        /// \brief Unicast address (e.g. not a wildcard, broadcast or multicast address)
+        UNICAST = 1 << 4,
+        /// \brief Linklocal address (e.g. 169.254.0.0/16 (aka self-assigned))
+        LINK_LOCAL = 1 << 5,
+        /// \brief Site local address (e.g. 10.0.0.0/8, 192.168.0.0/16 or 172.16.0.0 to 172.31.255.255)
+        SITE_LOCAL = 1 << 6,
+        /// \brief Any address type.
+        ANY_TYPE = (1 << 7) - 1
+    };
+
+    /// \brief Address family flags.
+    enum Families
+    {
+        /// \brief IPv4 addresses.
+        IPV4 = 1 << 0,
+        /// \brief IPv6 addresses.
+        IPV6 = 1 << 1,
+        /// \brief Any address family.
+        ANY_FAMILY = IPV4 | IPV6
+    };
+
+    /// \brief Interface state flags.
+    enum States
+    {
+        /// \brief Interfaces that are up.
+        UP = 1 << 0,
+        /// \brief Interfaces that are down.
+        DOWN = 1 << 1,
+        /// \brief Interfaces in any state.
+        ANY_STATE = UP | DOWN
+    };
+
+    /// \brief A reference to a matching address in a snapshot.
+    typedef std::reference_wrapper<const NetworkInterfaceSnapshot::Address> View;
+
+    /// \brief The matching addresses of one query run.
+    ///
+    /// The result keeps its snapshot alive, so the views stay valid for the
+    /// lifetime of the result even if the interfaces change.
+    class Result
+    {
+    public:
+        typedef std::vector<View>::const_iterator const_iterator;
+        typedef const_iterator iterator;
+
+        /// \brief Create an empty result.
+        Result();
+
+        /// \brief Create a result.
+        /// \param snapshot The snapshot the views refer to.
+        /// \param views The matching addresses.
+        Result(std::shared_ptr<const NetworkInterfaceSnapshot> snapshot,
+               std::vector<View> views);
+
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        /// \returns the number of matching addresses.
+        std::size_t size() const;
+
+        /// \returns true iff no address matched.
+        bool empty() const;
+
+        /// \returns the matching address at an index.
+        const NetworkInterfaceSnapshot::Address& operator [] (std::size_t index) const;
+
+        /// \returns the snapshot the views refer to.
+        std::shared_ptr<const NetworkInterfaceSnapshot> snapshot() const;
+
+    private:
+        std::shared_ptr<const NetworkInterfaceSnapshot> _snapshot;
+        std::vector<View> _views;
+
+    };
+
+    /// \brief Create a query that matches every address.
+    NetworkInterfaceQuery();
+
+    /// \brief Match addresses with any of the given types.
+    /// \param addressTypes A combination of AddressTypes flags.
+    /// \returns this query.
+    NetworkInterfaceQuery& setAddressTypes(uint32_t addressTypes);
+
+    /// \brief Match addresses of any of the given families.
+    /// \param families A combination of Families flags.
+    /// \returns this query.
+    NetworkInterfaceQuery& setFamilies(uint32_t families);
+
+    /// \brief Match addresses of interfaces in any of the given states.
+    /// \param states A combination of States flags.
+    /// \returns this query.
+    NetworkInterfaceQuery& setStates(uint32_t states);
+
+    /// \brief Match addresses inside a range.
+    ///
+    /// If any ranges are added, an address must be inside at least one.
+    ///
+    /// \param range The range.
+    /// \returns this query.
+    NetworkInterfaceQuery& addRange(const IPAddressRange& range);
+
+    /// \brief Remove all ranges.
+    /// \returns this query.
+    NetworkInterfaceQuery& clearRanges();
+
+    /// \param address A classified address.
+    /// \returns true iff the address matches every criterion.
+    bool matches(const NetworkInterfaceSnapshot::Address& address) const;
+
+    /// \brief Run the query against the current snapshot.
+    /// \returns the matching addresses.
+    Result run() const;
+
+    /// \brief Run the query against a snapshot.
+    /// \param snapshot The snapshot.
+    /// \returns the matching addresses.
+    Result run(std::shared_ptr<const NetworkInterfaceSnapshot> snapshot) const;
+
+    /// \brief Wait until the query matches at least one address.
+    ///
+    /// The query is run again each time the operating system reports a
+    /// change. See NetworkInterfaceSnapshot::waitFor().
+    ///
+    /// \param timeout The longest time to wait.
+    /// \returns the matching addresses, or an empty result on timeout.
+    Result waitFor(std::chrono::milliseconds timeout) const;
+
+    /// \brief Wait on another thread until the query matches.
+    ///
+    /// The query is copied, so it may be changed or destroyed while waiting.
+    ///
+    /// \param timeout The longest time to wait.
+    /// \returns a future for the matching addresses, or an empty result on
+    ///          timeout.
+    std::future<Result> waitForAsync(std::chrono::milliseconds timeout) const;
+
+    /// \param address An address.
+    /// \returns the AddressTypes flags of the address.
+    static uint32_t classify(const Poco::Net::IPAddress& address);
+
+private:
+    uint32_t _addressTypes;
+    uint32_t _families;
+    uint32_t _states;
+    std::vector<CompactIPAddressRange> _ranges;
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,216 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Poco/Net/IPAddress.h"
+#include "Poco/Net/NetworkInterface.h"
+#include "ofx/Net/CompactIPAddress.h"
+#include "ofx/Net/NetworkInterfaceEnumerator.h"
+#include "ofx/Net/NetworkInterfaceInfo.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief An immutable, process-wide view of the network interfaces.
+///
+/// Enumerating interfaces is a full sweep of the system interface tables,
+/// so the result is shared. current() returns the latest snapshot through
+/// an atomic shared pointer without taking a lock. Readers can hold on to a
+/// snapshot for as long as they like.
+///
+/// The snapshot is rebuilt on the first read after the operating system
+/// reports a link or address change, or after refresh() or invalidate() is
+/// called. Changes are reported by a netlink socket on Linux and Android, a
+/// routing socket on macOS and iOS, and IP Helper notifications on Windows.
+/// On other systems isWatching() is false and the snapshot only changes when
+/// refreshed explicitly.
+///
+/// Snapshots are built from a NetworkInterfaceEnumerator, which reads the
+/// kernel tables directly over netlink on Linux. The Poco forms, list() and
+/// map(), are only enumerated the first time they are asked for, so they may
+/// be slightly newer than interfaces().
+class NetworkInterfaceSnapshot
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /// \brief A function called when the snapshot is marked stale.
+    typedef std::function<void()> ChangeCallback;
+
+    /// \brief A condition on a snapshot.
+    typedef std::function<bool(const NetworkInterfaceSnapshot&)> Predicate;
+
+    /// \brief One address of one interface, classified when the snapshot
+    ///        is built.
+    struct Address
+    {
+        /// \brief The interface, an element of interfaces().
+        const NetworkInterfaceInfo* interface;
+
+        /// \brief The address.
+        Poco::Net::IPAddress address;
+
+        /// \brief The address in compact form, for range tests.
+        CompactIPAddress compact;
+
+        /// \brief The NetworkInterfaceQuery::AddressTypes of the address.
+        uint32_t addressTypes;
+    };
+
+    /// \brief Create a snapshot.
+    /// \param interfaces The interfaces, in index order.
+    /// \param generation The snapshot sequence number.
+    /// \param system True iff the interfaces describe this system, so list()
+    ///        and map() can be enumerated from Poco. Otherwise they are
+    ///        empty.
+    NetworkInterfaceSnapshot(NetworkInterfaceInfo::List interfaces,
+                             uint64_t generation,
+                             bool system = true);
+
+    NetworkInterfaceSnapshot(const NetworkInterfaceSnapshot&) = delete;
+    NetworkInterfaceSnapshot& operator = (const NetworkInterfaceSnapshot&) = delete;
+
+    /// \returns one entry per interface, in index order.
+    const NetworkInterfaceInfo::List& interfaces() const;
+
+    /// \returns the fingerprint of each entry of interfaces().
+    const std::vector<uint64_t>& fingerprints() const;
+
+    /// \returns one entry per interface address, as NetworkInterface::list().
+    const Poco::Net::NetworkInterface::List& list() const;
+
+    /// \returns one entry per interface, as NetworkInterface::map().
+    const Poco::Net::NetworkInterface::Map& map() const;
+
+    /// \returns every address of every interface, in interfaces() order.
+    const std::vector<Address>& addresses() const;
+
+    /// \returns the sequence number, which increases with every rebuild.
+    uint64_t generation() const;
+
+    /// \returns the time the snapshot was taken.
+    Clock::time_point created() const;
+
+    /// \returns true iff the snapshot describes this system's interfaces.
+    bool isSystem() const;
+
+    /// \brief Get the current snapshot.
+    ///
+    /// The first call enumerates the interfaces and starts watching for
+    /// changes. Later calls only rebuild the snapshot after a change.
+    ///
+    /// \returns the current snapshot.
+    static std::shared_ptr<const NetworkInterfaceSnapshot> current();
+
+    /// \brief Rebuild the snapshot now.
+    /// \returns the new snapshot.
+    static std::shared_ptr<const NetworkInterfaceSnapshot> refresh();
+
+    /// \brief Mark the snapshot stale so the next read rebuilds it.
+    static void invalidate();
+
+    /// \returns true iff the snapshot is rebuilt automatically on changes.
+    static bool isWatching();
+
+    /// \brief Register a function to call when the snapshot is marked stale.
+    ///
+    /// The function is called on the thread that detected the change, which
+    /// is usually the watcher thread, before the snapshot is rebuilt. It
+    /// should return quickly. It may read current(), but it must not call
+    /// invalidate() or add or remove change callbacks.
+    ///
+    /// \param callback The function.
+    /// \returns an id for removeChangeCallback().
+    static std::size_t addChangeCallback(ChangeCallback callback);
+
+    /// \brief Remove a change callback.
+    ///
+    /// Once this returns, the callback is not running and will not be called
+    /// again.
+    ///
+    /// \param id The id returned by addChangeCallback().
+    static void removeChangeCallback(std::size_t id);
+
+    /// \brief Wait until the interfaces satisfy a condition.
+    ///
+    /// The predicate is tested against the current snapshot, then again
+    /// each time the operating system reports a change, so the caller wakes
+    /// as soon as a matching snapshot exists and does not spin while nothing
+    /// changes. If changes are not being watched, the interfaces are
+    /// enumerated every DEFAULT_WAIT_POLL_INTERVAL milliseconds instead.
+    ///
+    /// \param predicate The condition. Called on the waiting thread.
+    /// \param timeout The longest time to wait. std::chrono::milliseconds::max()
+    ///        waits indefinitely.
+    /// \returns the first matching snapshot, or nullptr on timeout.
+    static std::shared_ptr<const NetworkInterfaceSnapshot> waitFor(Predicate predicate,
+                                                                   std::chrono::milliseconds timeout);
+
+    /// \brief Wait until the interfaces satisfy a condition, on another
+    ///        thread.
+    /// \param predicate The condition. Called on the waiting thread.
+    /// \param timeout The longest time to wait.
+    /// \returns a future for the first matching snapshot, or nullptr on
+    ///          timeout.
+    static std::future<std::shared_ptr<const NetworkInterfaceSnapshot>> waitForAsync(Predicate predicate,
+                                                                                      std::chrono::milliseconds timeout);
+
+    /// \brief Select the enumeration backend for later rebuilds.
+    ///
+    /// The default is NetworkInterfaceEnumerator::AUTOMATIC. The snapshot is
+    /// marked stale so the next read uses the new backend.
+    ///
+    /// \param backend The backend.
+    static void setBackend(NetworkInterfaceEnumerator::Backend backend);
+
+    /// \brief Hash the flags, MTU, hardware address and addresses of an
+    ///        interface.
+    ///
+    /// Two descriptions with the same state have the same fingerprint,
+    /// whatever the order of their addresses, so comparing fingerprints is
+    /// enough to skip interfaces that did not change.
+    ///
+    /// \param info The interface.
+    /// \returns the fingerprint.
+    static uint64_t fingerprint(const NetworkInterfaceInfo& info);
+
+    enum
+    {
+        /// \brief The waitFor() polling interval in milliseconds when changes
+        ///        are not being watched.
+        DEFAULT_WAIT_POLL_INTERVAL = 250
+    };
+
+private:
+    /// \brief Build list() and map() from Poco.
+    void buildPoco() const;
+
+    NetworkInterfaceInfo::List _interfaces;
+    std::vector<uint64_t> _fingerprints;
+    mutable std::once_flag _pocoOnce;
+    mutable Poco::Net::NetworkInterface::List _list;
+    mutable Poco::Net::NetworkInterface::Map _map;
+    std::vector<Address> _addresses;
+    uint64_t _generation = 0;
+    Clock::time_point _created;
+    bool _system = true;
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <memory>
+#include "ofx/Net/NetworkInterfaceSnapshot.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief Where a NetworkInterfaceListener gets its snapshots.
+///
+/// system() returns the source for this system's interfaces, which wraps
+/// the shared NetworkInterfaceSnapshot. Other sources, such as
+/// SyntheticNetworkInterfaceSource, supply interfaces that do not exist, so
+/// listeners can be tested and measured without real network hardware.
+///
+/// Every method may be called from any thread.
+class NetworkInterfaceSource
+{
+public:
+    typedef NetworkInterfaceSnapshot::ChangeCallback ChangeCallback;
+
+    virtual ~NetworkInterfaceSource();
+
+    /// \returns the current snapshot. The same pointer is returned until
+    ///          the interfaces change.
+    virtual std::shared_ptr<const NetworkInterfaceSnapshot> current() = 0;
+
+    /// \brief Enumerate the interfaces now.
+    /// \returns the new snapshot.
+    virtual std::shared_ptr<const NetworkInterfaceSnapshot> refresh() = 0;
+
+    /// \returns true iff change callbacks are called when the interfaces
+    ///          change.
+    virtual bool isWatching() const = 0;
+
+    /// \brief Register a function to call when the interfaces change.
+    ///
+    /// See NetworkInterfaceSnapshot::addChangeCallback().
+    ///
+    /// \param callback The function.
+    /// \returns an id for removeChangeCallback().
+    virtual std::size_t addChangeCallback(ChangeCallback callback) = 0;
+
+    /// \brief Remove a change callback.
+    ///
+    /// Once this returns, the callback is not running and will not be called
+    /// again.
+    ///
+    /// \param id The id returned by addChangeCallback().
+    virtual void removeChangeCallback(std::size_t id) = 0;
+
+    /// \returns the shared source for this system's interfaces.
+    static std::shared_ptr<NetworkInterfaceSource> system();
+
+};
+
+
+} } // namespace ofx::Net
@@ -8,10 +8,17 @@
 #pragma once
 
 
+#include <memory>
 #include <string>
+#include <vector>
 #include "Poco/Net/HostEntry.h"
 #include "Poco/Net/IPAddress.h"
 #include "Poco/Net/NetworkInterface.h"
+#include "ofx/Net/AsyncHostResolver.h"
+#include "ofx/Net/HostEntryCache.h"
+#include "ofx/Net/HostsTable.h"
+#include "ofx/Net/NetworkInterfaceQuery.h"
+#include "ofx/Net/NetworkInterfaceSnapshot.h"
 
 
 namespace ofx {
@@ -77,9 +84,90 @@ public:
     /// \returns a HostEntry for the given address.
     static HostEntry getHost(const std::string& address);
 
+    /// \brief Look up a batch of addresses concurrently.
+    ///
+    /// Duplicates are looked up once and answered from the host entry cache
+    /// when one is set. Lookups run on the shared resolver.
+    ///
+    /// \param addresses The addresses to query for host information.
+    /// \param maximumInFlight The maximum number of concurrent lookups.
+    /// \returns one result per address, in input order.
+    /// \sa getHostResolver()
+    static std::vector<AsyncHostResolver::Result> getHostsByAddress(const std::vector<Poco::Net::IPAddress>& addresses,
+                                                                   std::size_t maximumInFlight = AsyncHostResolver::DEFAULT_MAXIMUM_IN_FLIGHT);
+
     /// \returns a HostEntry about this system.
     static HostEntry getThisHost();
 
+    /// \brief Look up a host name without blocking.
+    /// \param hostname The hostname to query for host information.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    /// \sa getHostResolver()
+    static AsyncHostResolver::Request getHostByNameAsync(const std::string& hostname,
+                                                         AsyncHostResolver::Callback callback = nullptr);
+
+    /// \brief Look up an address without blocking.
+    /// \param ipAddress The address to query for host information.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    static AsyncHostResolver::Request getHostByAddressAsync(const Poco::Net::IPAddress& ipAddress,
+                                                            AsyncHostResolver::Callback callback = nullptr);
+
+    /// \brief Look up a host name or address without blocking.
+    /// \param address The address to query for host information.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    static AsyncHostResolver::Request getHostAsync(const std::string& address,
+                                                   AsyncHostResolver::Callback callback = nullptr);
+
+    /// \brief Look up this system without blocking.
+    /// \param callback An optional completion callback.
+    /// \returns a handle to the request.
+    static AsyncHostResolver::Request getThisHostAsync(AsyncHostResolver::Callback callback = nullptr);
+
+    /// \brief Get the resolver used by the asynchronous lookups.
+    ///
+    /// A resolver with default settings is created on first use.
+    ///
+    /// \returns the shared resolver.
+    static std::shared_ptr<AsyncHostResolver> getHostResolver();
+
+    /// \brief Replace the resolver used by the asynchronous lookups.
+    ///
+    /// Requests already submitted to the previous resolver are unaffected
+    /// until it is destroyed.
+    ///
+    /// \param resolver The new resolver. If nullptr, a resolver with default
+    ///        settings is created on next use.
+    static void setHostResolver(std::shared_ptr<AsyncHostResolver> resolver);
+
+    /// \brief Get the backend used by the blocking lookups.
+    /// \returns the backend, AsyncHostResolver::systemBackend() by default.
+    static AsyncHostResolver::Backend getHostResolverBackend();
+
+    /// \brief Replace the backend used by the blocking lookups.
+    ///
+    /// The backend is also used by the shared resolver if it is created
+    /// after this call, and by the host entry cache on a miss. To answer
+    /// known names from memory, pass a HostsTable::backend().
+    ///
+    /// \param backend The new backend. If empty, the system backend is used.
+    static void setHostResolverBackend(AsyncHostResolver::Backend backend);
+
+    /// \brief Get the cache used by the blocking lookups.
+    /// \returns the shared cache or nullptr if caching is disabled.
+    static std::shared_ptr<HostEntryCache> getHostEntryCache();
+
+    /// \brief Set the cache used by the blocking lookups.
+    ///
+    /// When a cache is set, getHostByName(), getHostByAddress() and getHost()
+    /// answer from it and store new results in it. Caching is disabled by
+    /// default.
+    ///
+    /// \param cache The new cache, or nullptr to disable caching.
+    static void setHostEntryCache(std::shared_ptr<HostEntryCache> cache);
+
     /// \brief List all network interfaces of a given AddressType.
     /// \param addressType The AddressType to search for.
     /// \param ipVersion The IPVersion to search for.
@@ -87,6 +175,21 @@ public:
     static NetworkInterfaceList listNetworkInterfaces(AddressType addressType,
                                                       NetworkInterface::IPVersion ipVersion = NetworkInterface::IPv4_OR_IPv6);
 
+    /// \brief Find the interface addresses that match a query.
+    ///
+    /// Unlike listNetworkInterfaces(), any combination of address types,
+    /// families, states and ranges can be matched in one pass, and the
+    /// results refer to the shared snapshot instead of copying interfaces.
+    ///
+    /// \param query The query.
+    /// \returns the matching addresses.
+    static NetworkInterfaceQuery::Result findNetworkInterfaces(const NetworkInterfaceQuery& query);
+
+    /// \brief Convert an AddressType to its NetworkInterfaceQuery flag.
+    /// \param addressType The AddressType.
+    /// \returns the flag, or NetworkInterfaceQuery::ANY_TYPE for ANY.
+    static uint32_t toAddressTypes(AddressType addressType);
+
     /// \brief Get a public IP address for the default interface.
     /// \param url The public IP address discovery endpoint.
     ///        Users may choose to use their own endpoint. The
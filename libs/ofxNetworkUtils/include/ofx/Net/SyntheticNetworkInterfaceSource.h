@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ofx/Net/NetworkInterfaceInfo.h"
+#include "ofx/Net/NetworkInterfaceSource.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief A NetworkInterfaceSource of made-up interfaces.
+///
+/// The interfaces are whatever was last published, so any number of them
+/// can be generated, changed and replayed without real network hardware or
+/// privileges:
+///
+///     auto source = std::make_shared<SyntheticNetworkInterfaceSource>();
+///     NetworkInterfaceListener listener(source);
+///
+///     source->play(SyntheticNetworkInterfaceSource::generate(5000, 1000, 1));
+///
+///     while (source->step())
+///         ofEvents().update.notify(args);
+///
+/// A Recording is an initial list of interfaces and a sequence of changes.
+/// Recordings can be generated, taken from real snapshots with
+/// difference(), and saved to and loaded from text files, so a sequence seen
+/// in the field can be replayed exactly.
+///
+/// Snapshots from this source are not system snapshots (see
+/// NetworkInterfaceSnapshot::isSystem()), so their Poco forms are empty.
+/// The methods that change the interfaces must not be called concurrently
+/// with each other.
+class SyntheticNetworkInterfaceSource: public NetworkInterfaceSource
+{
+public:
+    /// \brief One step of a recording.
+    struct Change
+    {
+        /// \brief Interfaces that appeared or changed, in their new state.
+        NetworkInterfaceInfo::List updated;
+
+        /// \brief The indices of interfaces that disappeared.
+        std::vector<unsigned> removed;
+    };
+
+    /// \brief A sequence of interface states.
+    struct Recording
+    {
+        /// \brief The interfaces at the start.
+        NetworkInterfaceInfo::List initial;
+
+        /// \brief The changes, in order.
+        std::vector<Change> changes;
+    };
+
+    /// \brief Create a source with no interfaces.
+    SyntheticNetworkInterfaceSource();
+
+    /// \brief Create a source.
+    /// \param interfaces The initial interfaces.
+    explicit SyntheticNetworkInterfaceSource(NetworkInterfaceInfo::List interfaces);
+
+    std::shared_ptr<const NetworkInterfaceSnapshot> current() override;
+
+    /// \returns the current snapshot. There is nothing to enumerate.
+    std::shared_ptr<const NetworkInterfaceSnapshot> refresh() override;
+
+    /// \returns true. Callbacks are called by every publish().
+    bool isWatching() const override;
+
+    std::size_t addChangeCallback(ChangeCallback callback) override;
+    void removeChangeCallback(std::size_t id) override;
+
+    /// \brief Replace the interfaces and call the change callbacks.
+    /// \param interfaces The interfaces, in any order.
+    void publish(NetworkInterfaceInfo::List interfaces);
+
+    /// \brief Apply a change to the interfaces and call the change callbacks.
+    /// \param change The change.
+    void apply(const Change& change);
+
+    /// \brief Publish the initial interfaces of a recording and queue its
+    ///        changes for step().
+    /// \param recording The recording.
+    void play(Recording recording);
+
+    /// \brief Apply the next queued change.
+    /// \returns false if there were no more changes.
+    bool step();
+
+    /// \returns the number of queued changes.
+    std::size_t remaining() const;
+
+    /// \brief Make up an interface.
+    ///
+    /// The interface is up and running, has a locally administered hardware
+    /// address and one IPv4 and one IPv6 address derived from the index.
+    ///
+    /// \param index The interface index, from 1 to 65535.
+    /// \returns the interface.
+    static NetworkInterfaceInfo generateInterface(unsigned index);
+
+    /// \brief Make up a list of interfaces.
+    /// \param count The number of interfaces, with indices 1 to count.
+    /// \returns the interfaces.
+    static NetworkInterfaceInfo::List generate(std::size_t count);
+
+    /// \brief Make up a recording.
+    ///
+    /// Each change adds or removes an address, toggles the running flag,
+    /// changes the MTU, or adds or removes an interface. Added interfaces
+    /// take new indices up to 65535, after which none are added. The same
+    /// arguments always give the same recording.
+    ///
+    /// \param count The number of initial interfaces.
+    /// \param changes The number of changes.
+    /// \param seed The random seed.
+    /// \returns the recording.
+    static Recording generate(std::size_t count,
+                              std::size_t changes,
+                              uint32_t seed);
+
+    /// \brief Describe how one list of interfaces became another.
+    /// \param before The earlier interfaces, in index order.
+    /// \param after The later interfaces, in index order.
+    /// \returns the change.
+    static Change difference(const NetworkInterfaceInfo::List& before,
+                             const NetworkInterfaceInfo::List& after);
+
+    /// \brief Apply a change to a list of interfaces.
+    /// \param interfaces The interfaces, in index order.
+    /// \param change The change.
+    static void apply(NetworkInterfaceInfo::List& interfaces,
+                      const Change& change);
+
+    /// \brief Save a recording as text.
+    /// \param path The file path.
+    /// \param recording The recording.
+    /// \returns true iff the file was written.
+    static bool save(const std::string& path, const Recording& recording);
+
+    /// \brief Load a recording saved by save().
+    /// \param path The file path.
+    /// \param recording The recording, replacing the previous contents.
+    /// \returns true iff the file was read.
+    static bool load(const std::string& path, Recording& recording);
+
+private:
+    /// \brief Guards _snapshot, _recording and _position.
+    mutable std::mutex _mutex;
+
+    std::shared_ptr<const NetworkInterfaceSnapshot> _snapshot;
+    uint64_t _generation = 0;
+
+    Recording _recording;
+    std::size_t _position = 0;
+
+    /// \brief Held while callbacks are added, removed or called.
+    std::mutex _callbackMutex;
+    std::map<std::size_t, ChangeCallback> _callbacks;
+    std::size_t _lastCallbackId = 0;
+
+};
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,576 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/AsyncHostResolver.h"
+#include <algorithm>
+#include <unordered_map>
+#include "Poco/Exception.h"
+#include "Poco/Net/DNS.h"
+#include "Poco/Net/NetException.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief The state of one request.
+struct AsyncHostResolver::Request::Waiter
+{
+    Waiter(Callback callback):
+        callback(callback),
+        future(promise.get_future().share()),
+        done(false)
+    {
+    }
+
+    /// \brief Fulfill the request once.
+    /// \returns true iff this call completed the request.
+    bool complete(const Result& result)
+    {
+        if (done.exchange(true))
+            return false;
+
+        if (resolver)
+            resolver->removeDeadline(*this);
+
+        promise.set_value(result);
+
+        if (callback)
+        {
+            try
+            {
+                callback(result);
+            }
+            catch (const std::exception& exc)
+            {
+                ofLogError("AsyncHostResolver::Request") << "Callback threw: " << exc.what();
+            }
+            catch (...)
+            {
+                ofLogError("AsyncHostResolver::Request") << "Callback threw an unknown exception.";
+            }
+        }
+
+        // Release anything the callback captured.
+        callback = nullptr;
+        return true;
+    }
+
+    Callback callback;
+    std::promise<Result> promise;
+    std::shared_future<Result> future;
+    std::atomic<bool> done;
+
+    /// \brief The resolver holding the deadline, or nullptr. Set before the
+    ///        request can complete and outlived by every pending request.
+    AsyncHostResolver* resolver = nullptr;
+
+    /// \brief The entry in _deadlines. Guarded by the resolver mutex.
+    bool hasDeadline = false;
+    Deadlines::iterator deadline;
+};
+
+
+/// \brief A queued or running lookup shared by all requests for one query.
+struct AsyncHostResolver::Lookup
+{
+    Query query;
+    std::string key;
+    std::vector<std::shared_ptr<Request::Waiter>> waiters;
+
+    /// \returns true iff at least one request is still waiting.
+    bool isWanted() const
+    {
+        for (const auto& waiter: waiters)
+        {
+            if (!waiter->done)
+                return true;
+        }
+
+        return false;
+    }
+};
+
+
+namespace {
+
+
+AsyncHostResolver::Result makeResult(AsyncHostResolver::Status status,
+                                     const std::string& message)
+{
+    AsyncHostResolver::Result result;
+    result.status = status;
+    result.message = message;
+    return result;
+}
+
+
+} // namespace
+
+
+std::string AsyncHostResolver::Query::key() const
+{
+    return std::to_string(static_cast<int>(type)) + ":" + host;
+}
+
+
+bool AsyncHostResolver::Result::success() const
+{
+    return status == Status::SUCCESS;
+}
+
+
+AsyncHostResolver::Request::Request()
+{
+}
+
+
+AsyncHostResolver::Request::Request(std::shared_ptr<Waiter> waiter):
+    _waiter(waiter)
+{
+}
+
+
+std::shared_future<AsyncHostResolver::Result> AsyncHostResolver::Request::future() const
+{
+    return _waiter ? _waiter->future : std::shared_future<Result>();
+}
+
+
+bool AsyncHostResolver::Request::cancel()
+{
+    return _waiter && _waiter->complete(makeResult(Status::CANCELLED, "Cancelled."));
+}
+
+
+bool AsyncHostResolver::Request::isDone() const
+{
+    return !_waiter || _waiter->done;
+}
+
+
+bool AsyncHostResolver::Request::isValid() const
+{
+    return _waiter != nullptr;
+}
+
+
+AsyncHostResolver::AsyncHostResolver():
+    AsyncHostResolver(Settings())
+{
+}
+
+
+AsyncHostResolver::AsyncHostResolver(const Settings& settings):
+    _settings(settings),
+    _stopping(false)
+{
+    if (!_settings.backend)
+        _settings.backend = systemBackend();
+
+    _settings.threadCount = std::max(_settings.threadCount, std::size_t(1));
+
+    for (std::size_t i = 0; i < _settings.threadCount; ++i)
+        _workers.push_back(std::thread(&AsyncHostResolver::work, this));
+
+    _timeoutThread = std::thread(&AsyncHostResolver::expire, this);
+}
+
+
+AsyncHostResolver::~AsyncHostResolver()
+{
+    std::deque<std::shared_ptr<Lookup>> queue;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+        queue.swap(_queue);
+    }
+
+    _workCondition.notify_all();
+    _timeoutCondition.notify_all();
+
+    for (auto& lookup: queue)
+    {
+        for (auto& waiter: lookup->waiters)
+            waiter->complete(makeResult(Status::CANCELLED, "The resolver was destroyed."));
+    }
+
+    for (auto& worker: _workers)
+        worker.join();
+
+    _timeoutThread.join();
+}
+
+
+AsyncHostResolver::Request AsyncHostResolver::getHostByName(const std::string& hostname,
+                                                            Callback callback)
+{
+    return submit({ QueryType::HOST_BY_NAME, hostname }, callback);
+}
+
+
+AsyncHostResolver::Request AsyncHostResolver::getHostByAddress(const Poco::Net::IPAddress& address,
+                                                               Callback callback)
+{
+    return submit({ QueryType::HOST_BY_ADDRESS, address.toString() }, callback);
+}
+
+
+AsyncHostResolver::Request AsyncHostResolver::getHost(const std::string& address,
+                                                      Callback callback)
+{
+    return submit({ QueryType::RESOLVE, address }, callback);
+}
+
+
+AsyncHostResolver::Request AsyncHostResolver::getThisHost(Callback callback)
+{
+    return submit({ QueryType::THIS_HOST, "" }, callback);
+}
+
+
+std::vector<AsyncHostResolver::Result> AsyncHostResolver::getHostsByAddress(const Poco::Net::IPAddress* addresses,
+                                                                           std::size_t count,
+                                                                           std::size_t maximumInFlight,
+                                                                           std::chrono::milliseconds timeout)
+{
+    std::vector<Query> queries;
+    queries.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i)
+        queries.push_back({ QueryType::HOST_BY_ADDRESS, addresses[i].toString() });
+
+    return resolveAll(queries, maximumInFlight, timeout);
+}
+
+
+std::vector<AsyncHostResolver::Result> AsyncHostResolver::getHostsByAddress(const std::vector<Poco::Net::IPAddress>& addresses,
+                                                                           std::size_t maximumInFlight)
+{
+    return getHostsByAddress(addresses.data(),
+                             addresses.size(),
+                             maximumInFlight,
+                             _settings.defaultTimeout);
+}
+
+
+std::vector<AsyncHostResolver::Result> AsyncHostResolver::resolveAll(const std::vector<Query>& queries,
+                                                                    std::size_t maximumInFlight,
+                                                                    std::chrono::milliseconds timeout)
+{
+    // Map each query to the first query with the same key.
+    std::vector<std::size_t> unique;
+    std::vector<std::size_t> slots(queries.size());
+    std::unordered_map<std::string, std::size_t> seen;
+
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        auto inserted = seen.insert(std::make_pair(queries[i].key(), unique.size()));
+
+        if (inserted.second)
+            unique.push_back(i);
+
+        slots[i] = inserted.first->second;
+    }
+
+    // Shared with the callbacks, which may run after a timeout returns.
+    struct Batch
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::size_t running = 0;
+        std::vector<Result> results;
+    };
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->results.resize(unique.size());
+
+    const std::size_t limit = std::max(std::min(maximumInFlight, _settings.maximumQueueSize), std::size_t(1));
+
+    for (std::size_t i = 0; i < unique.size(); ++i)
+    {
+        {
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->condition.wait(lock, [&batch, limit]() { return batch->running < limit; });
+            ++batch->running;
+        }
+
+        submit(queries[unique[i]], timeout, [batch, i](const Result& result) {
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->results[i] = result;
+            --batch->running;
+            batch->condition.notify_all();
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->condition.wait(lock, [&batch]() { return batch->running == 0; });
+    }
+
+    std::vector<Result> results;
+    results.reserve(queries.size());
+
+    for (auto slot: slots)
+        results.push_back(batch->results[slot]);
+
+    return results;
+}
+
+
+AsyncHostResolver::Request AsyncHostResolver::submit(const Query& query,
+                                                     Callback callback)
+{
+    return submit(query, _settings.defaultTimeout, callback);
+}
+
+
+AsyncHostResolver::Request AsyncHostResolver::submit(const Query& query,
+                                                     std::chrono::milliseconds timeout,
+                                                     Callback callback)
+{
+    std::shared_ptr<Request::Waiter> waiter = std::make_shared<Request::Waiter>(callback);
+    const std::string key = query.key();
+    Status failure = Status::SUCCESS;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto iter = _inFlight.find(key);
+
+        if (iter == _inFlight.end() && _queue.size() >= _settings.maximumQueueSize)
+            pruneQueue();
+
+        if (_stopping)
+        {
+            failure = Status::CANCELLED;
+        }
+        else if (iter != _inFlight.end())
+        {
+            iter->second->waiters.push_back(waiter);
+        }
+        else if (_queue.size() >= _settings.maximumQueueSize)
+        {
+            failure = Status::REJECTED;
+        }
+        else
+        {
+            std::shared_ptr<Lookup> lookup = std::make_shared<Lookup>();
+            lookup->query = query;
+            lookup->key = key;
+            lookup->waiters.push_back(waiter);
+            _inFlight[key] = lookup;
+            _queue.push_back(lookup);
+            _workCondition.notify_one();
+        }
+
+        if (failure == Status::SUCCESS)
+        {
+            waiter->resolver = this;
+            waiter->hasDeadline = true;
+            waiter->deadline = _deadlines.insert(std::make_pair(Clock::now() + timeout, waiter));
+
+            if (waiter->deadline == _deadlines.begin())
+                _timeoutCondition.notify_one();
+        }
+    }
+
+    if (failure == Status::CANCELLED)
+        waiter->complete(makeResult(failure, "The resolver is shutting down."));
+    else if (failure == Status::REJECTED)
+        waiter->complete(makeResult(failure, "Too many queued lookups."));
+
+    return Request(waiter);
+}
+
+
+std::size_t AsyncHostResolver::inFlight() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _inFlight.size();
+}
+
+
+const AsyncHostResolver::Settings& AsyncHostResolver::settings() const
+{
+    return _settings;
+}
+
+
+AsyncHostResolver::Backend AsyncHostResolver::systemBackend()
+{
+    return [](const Query& query) {
+        switch (query.type)
+        {
+            case QueryType::HOST_BY_NAME:
+                return Poco::Net::DNS::hostByName(query.host);
+            case QueryType::HOST_BY_ADDRESS:
+                return Poco::Net::DNS::hostByAddress(Poco::Net::IPAddress(query.host));
+            case QueryType::RESOLVE:
+                return Poco::Net::DNS::resolve(query.host);
+            case QueryType::THIS_HOST:
+                return Poco::Net::DNS::thisHost();
+        }
+
+        return HostEntry();
+    };
+}
+
+
+AsyncHostResolver::Result AsyncHostResolver::resolve(const Backend& backend,
+                                                     const Query& query)
+{
+    try
+    {
+        Result result;
+        result.status = Status::SUCCESS;
+        result.hostEntry = backend(query);
+        return result;
+    }
+    catch (const Poco::Net::HostNotFoundException& exc)
+    {
+        return makeResult(Status::NOT_FOUND, exc.displayText());
+    }
+    catch (const Poco::Net::NoAddressFoundException& exc)
+    {
+        return makeResult(Status::NO_ADDRESS_FOUND, exc.displayText());
+    }
+    catch (const Poco::Net::DNSException& exc)
+    {
+        return makeResult(Status::DNS_ERROR, exc.displayText());
+    }
+    catch (const Poco::TimeoutException& exc)
+    {
+        return makeResult(Status::TIMEOUT, exc.displayText());
+    }
+    catch (const Poco::Exception& exc)
+    {
+        return makeResult(Status::UNKNOWN_ERROR, exc.displayText());
+    }
+    catch (const std::exception& exc)
+    {
+        return makeResult(Status::UNKNOWN_ERROR, exc.what());
+    }
+    catch (...)
+    {
+        return makeResult(Status::UNKNOWN_ERROR, "Unknown Exception: " + query.host);
+    }
+}
+
+
+void AsyncHostResolver::work()
+{
+    while (true)
+    {
+        std::shared_ptr<Lookup> lookup;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            _workCondition.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+
+            if (_stopping)
+                return;
+
+            lookup = _queue.front();
+            _queue.pop_front();
+
+            if (!lookup->isWanted())
+            {
+                // Every request for this lookup was cancelled or timed out.
+                _inFlight.erase(lookup->key);
+                continue;
+            }
+        }
+
+        Result result = resolve(_settings.backend, lookup->query);
+
+        std::vector<std::shared_ptr<Request::Waiter>> waiters;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _inFlight.erase(lookup->key);
+            waiters.swap(lookup->waiters);
+        }
+
+        for (auto& waiter: waiters)
+            waiter->complete(result);
+    }
+}
+
+
+void AsyncHostResolver::expire()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stopping)
+    {
+        if (_deadlines.empty())
+        {
+            _timeoutCondition.wait(lock);
+            continue;
+        }
+
+        auto first = _deadlines.begin();
+
+        if (Clock::now() < first->first)
+        {
+            _timeoutCondition.wait_until(lock, first->first);
+            continue;
+        }
+
+        std::shared_ptr<Request::Waiter> waiter = first->second.lock();
+        _deadlines.erase(first);
+
+        if (waiter)
+            waiter->hasDeadline = false;
+
+        if (waiter && !waiter->done)
+        {
+            // Complete outside of the lock so callbacks may submit requests.
+            lock.unlock();
+            waiter->complete(makeResult(Status::TIMEOUT, "The request timed out."));
+            lock.lock();
+        }
+    }
+}
+
+
+void AsyncHostResolver::pruneQueue()
+{
+    auto iter = _queue.begin();
+
+    while (iter != _queue.end())
+    {
+        if ((*iter)->isWanted())
+        {
+            ++iter;
+        }
+        else
+        {
+            _inFlight.erase((*iter)->key);
+            iter = _queue.erase(iter);
+        }
+    }
+}
+
+
+void AsyncHostResolver::removeDeadline(Request::Waiter& waiter)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (waiter.hasDeadline)
+    {
+        _deadlines.erase(waiter.deadline);
+        waiter.hasDeadline = false;
+    }
+}
+
+
+} } // namespace ofx::Net
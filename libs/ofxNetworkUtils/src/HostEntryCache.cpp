@@ -0,0 +1,370 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/HostEntryCache.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace ofx {
+namespace Net {
+
+
+/// \brief The cache contents and counters.
+///
+/// Held by shared pointer so that a refresh completing after the cache is
+/// destroyed can detect it.
+struct HostEntryCache::State
+{
+    /// \brief A cached result.
+    struct Entry
+    {
+        std::string key;
+        Query query;
+        Result result;
+        Clock::time_point refreshAt;
+        Clock::time_point expires;
+        uint32_t hits;
+        bool refreshing;
+    };
+
+    /// \brief One independently locked part of the cache.
+    struct Shard
+    {
+        std::mutex mutex;
+
+        /// \brief Entries, most recently used first.
+        std::list<Entry> entries;
+
+        /// \brief Entries by key.
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    };
+
+    State(const Settings& settings):
+        settings(settings),
+        shardCapacity(0),
+        hits(0),
+        negativeHits(0),
+        misses(0),
+        evictions(0),
+        expirations(0),
+        refreshes(0)
+    {
+        if (!this->settings.backend)
+            this->settings.backend = AsyncHostResolver::systemBackend();
+
+        const std::size_t count = std::max(this->settings.shardCount, std::size_t(1));
+        this->settings.shardCount = count;
+
+        shardCapacity = std::max((this->settings.capacity + count - 1) / count, std::size_t(1));
+
+        for (std::size_t i = 0; i < count; ++i)
+            shards.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+
+    Shard& shardFor(const std::string& key)
+    {
+        return *shards[std::hash<std::string>()(key) % shards.size()];
+    }
+
+    /// \brief Look up an entry.
+    /// \param refresh Set to true iff the caller should start a refresh.
+    bool find(const Query& query, Result& result, bool& refresh)
+    {
+        const std::string key = query.key();
+        const Clock::time_point now = Clock::now();
+        Shard& shard = shardFor(key);
+
+        refresh = false;
+
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        auto iter = shard.index.find(key);
+
+        if (iter == shard.index.end())
+        {
+            ++misses;
+            return false;
+        }
+
+        Entry& entry = *iter->second;
+
+        if (entry.expires <= now)
+        {
+            shard.entries.erase(iter->second);
+            shard.index.erase(iter);
+            ++expirations;
+            ++misses;
+            return false;
+        }
+
+        shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+
+        ++hits;
+
+        if (!entry.result.success())
+            ++negativeHits;
+
+        ++entry.hits;
+
+        if (settings.resolver
+        && !entry.refreshing
+        && entry.hits >= settings.refreshAheadHits
+        && entry.refreshAt <= now)
+        {
+            entry.refreshing = true;
+            refresh = true;
+        }
+
+        result = entry.result;
+        return true;
+    }
+
+    void insert(const Query& query,
+                const Result& result,
+                std::chrono::milliseconds timeToLive)
+    {
+        if (timeToLive.count() <= 0)
+            return;
+
+        const std::string key = query.key();
+        const Clock::time_point now = Clock::now();
+        const float fraction = std::min(std::max(settings.refreshAhead, 0.0f), 1.0f);
+
+        Entry entry;
+        entry.key = key;
+        entry.query = query;
+        entry.result = result;
+        entry.expires = now + timeToLive;
+        entry.refreshAt = now + std::chrono::duration_cast<Clock::duration>(timeToLive * fraction);
+        entry.hits = 0;
+        entry.refreshing = false;
+
+        Shard& shard = shardFor(key);
+
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        auto iter = shard.index.find(key);
+
+        if (iter != shard.index.end())
+        {
+            *iter->second = entry;
+            shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+            return;
+        }
+
+        shard.entries.push_front(entry);
+        shard.index[key] = shard.entries.begin();
+
+        while (shard.entries.size() > shardCapacity)
+        {
+            shard.index.erase(shard.entries.back().key);
+            shard.entries.pop_back();
+            ++evictions;
+        }
+    }
+
+    /// \brief Store a refreshed result, or allow another refresh on failure.
+    void completeRefresh(const Query& query, const Result& result)
+    {
+        if (isCacheable(result.status))
+        {
+            insert(query, result, timeToLiveFor(result.status));
+            return;
+        }
+
+        // Keep serving the old result until it expires.
+        const std::string key = query.key();
+        Shard& shard = shardFor(key);
+
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        auto iter = shard.index.find(key);
+
+        if (iter != shard.index.end())
+            iter->second->refreshing = false;
+    }
+
+    std::chrono::milliseconds timeToLiveFor(AsyncHostResolver::Status status) const
+    {
+        return status == AsyncHostResolver::Status::SUCCESS ? settings.positiveTimeToLive
+                                                            : settings.negativeTimeToLive;
+    }
+
+    Settings settings;
+    std::size_t shardCapacity;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> negativeHits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> expirations;
+    std::atomic<uint64_t> refreshes;
+};
+
+
+HostEntryCache::HostEntryCache():
+    HostEntryCache(Settings())
+{
+}
+
+
+HostEntryCache::HostEntryCache(const Settings& settings):
+    _state(std::make_shared<State>(settings))
+{
+}
+
+
+HostEntryCache::~HostEntryCache()
+{
+}
+
+
+HostEntryCache::Result HostEntryCache::resolve(const Query& query)
+{
+    return resolve(query, _state->settings.backend);
+}
+
+
+HostEntryCache::Result HostEntryCache::resolve(const Query& query,
+                                               const AsyncHostResolver::Backend& backend)
+{
+    Result result;
+
+    if (find(query, result))
+        return result;
+
+    result = AsyncHostResolver::resolve(backend, query);
+    insert(query, result);
+    return result;
+}
+
+
+bool HostEntryCache::find(const Query& query, Result& result)
+{
+    bool refreshNow = false;
+
+    if (!_state->find(query, result, refreshNow))
+        return false;
+
+    if (refreshNow)
+        refresh(query);
+
+    return true;
+}
+
+
+void HostEntryCache::insert(const Query& query, const Result& result)
+{
+    if (isCacheable(result.status))
+        _state->insert(query, result, _state->timeToLiveFor(result.status));
+}
+
+
+void HostEntryCache::insert(const Query& query,
+                            const Result& result,
+                            std::chrono::milliseconds timeToLive)
+{
+    _state->insert(query, result, timeToLive);
+}
+
+
+void HostEntryCache::erase(const Query& query)
+{
+    const std::string key = query.key();
+    State::Shard& shard = _state->shardFor(key);
+
+    std::unique_lock<std::mutex> lock(shard.mutex);
+
+    auto iter = shard.index.find(key);
+
+    if (iter != shard.index.end())
+    {
+        shard.entries.erase(iter->second);
+        shard.index.erase(iter);
+    }
+}
+
+
+void HostEntryCache::clear()
+{
+    for (auto& shard: _state->shards)
+    {
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->index.clear();
+    }
+}
+
+
+HostEntryCache::Statistics HostEntryCache::statistics() const
+{
+    Statistics statistics;
+    statistics.hits = _state->hits;
+    statistics.negativeHits = _state->negativeHits;
+    statistics.misses = _state->misses;
+    statistics.evictions = _state->evictions;
+    statistics.expirations = _state->expirations;
+    statistics.refreshes = _state->refreshes;
+
+    for (auto& shard: _state->shards)
+    {
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        statistics.size += shard->entries.size();
+    }
+
+    return statistics;
+}
+
+
+void HostEntryCache::resetStatistics()
+{
+    _state->hits = 0;
+    _state->negativeHits = 0;
+    _state->misses = 0;
+    _state->evictions = 0;
+    _state->expirations = 0;
+    _state->refreshes = 0;
+}
+
+
+const HostEntryCache::Settings& HostEntryCache::settings() const
+{
+    return _state->settings;
+}
+
+
+bool HostEntryCache::isCacheable(AsyncHostResolver::Status status)
+{
+    return status == AsyncHostResolver::Status::SUCCESS
+        || status == AsyncHostResolver::Status::NOT_FOUND
+        || status == AsyncHostResolver::Status::NO_ADDRESS_FOUND;
+}
+
+
+void HostEntryCache::refresh(const Query& query)
+{
+    ++_state->refreshes;
+
+    std::weak_ptr<State> state = _state;
+
+    _state->settings.resolver->submit(query, [state, query](const Result& result) {
+        std::shared_ptr<State> current = state.lock();
+
+        if (current)
+            current->completeRefresh(query, result);
+    });
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,270 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/HostsTable.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/SocketDefs.h"
+#include "ofUtils.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+#if defined(TARGET_WIN32)
+const std::string HostsTable::DEFAULT_PATH = "C:\\Windows\\System32\\drivers\\etc\\hosts";
+#else
+const std::string HostsTable::DEFAULT_PATH = "/etc/hosts";
+#endif
+
+
+HostsTable::HostsTable()
+{
+}
+
+
+bool HostsTable::load(const std::string& path)
+{
+    std::ifstream stream(ofToDataPath(path, true).c_str(), std::ios::binary);
+
+    if (!stream)
+        return false;
+
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+
+    if (stream.bad())
+        return false;
+
+    parse(buffer.str());
+    return true;
+}
+
+
+std::size_t HostsTable::parse(const std::string& text)
+{
+    std::size_t count = 0;
+    std::istringstream lines(text);
+    std::string line;
+
+    while (std::getline(lines, line))
+    {
+        const std::size_t comment = line.find('#');
+
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string address;
+        std::string name;
+
+        if (!(fields >> address >> name))
+            continue;
+
+        Poco::Net::IPAddress ipAddress;
+
+        if (!Poco::Net::IPAddress::tryParse(address, ipAddress))
+            continue;
+
+        std::vector<std::string> aliases;
+        std::string alias;
+
+        while (fields >> alias)
+            aliases.push_back(alias);
+
+        add(ipAddress, name, aliases);
+        ++count;
+    }
+
+    return count;
+}
+
+
+void HostsTable::add(const Poco::Net::IPAddress& address,
+                     const std::string& name,
+                     const std::vector<std::string>& aliases)
+{
+    auto inserted = _names.insert(std::make_pair(toKey(name), _hosts.size()));
+    const std::size_t index = inserted.first->second;
+
+    if (inserted.second)
+    {
+        Host host;
+        host.name = name;
+        _hosts.push_back(host);
+    }
+
+    Host& host = _hosts[index];
+
+    if (std::find(host.addresses.begin(), host.addresses.end(), address) == host.addresses.end())
+    {
+        host.addresses.push_back(address);
+        update(host);
+    }
+
+    _addresses.insert(std::make_pair(CompactIPAddress(address), index));
+
+    for (const auto& alias: aliases)
+        _names.insert(std::make_pair(toKey(alias), index));
+}
+
+
+bool HostsTable::findByName(const std::string& name, HostEntry& hostEntry) const
+{
+    auto iter = _names.find(toKey(name));
+
+    if (iter == _names.end())
+        return false;
+
+    hostEntry = _hosts[iter->second].hostEntry;
+    return true;
+}
+
+
+bool HostsTable::findByAddress(const Poco::Net::IPAddress& address, HostEntry& hostEntry) const
+{
+    auto iter = _addresses.find(CompactIPAddress(address));
+
+    if (iter == _addresses.end())
+        return false;
+
+    hostEntry = _hosts[iter->second].hostEntry;
+    return true;
+}
+
+
+std::size_t HostsTable::size() const
+{
+    return _names.size();
+}
+
+
+bool HostsTable::empty() const
+{
+    return _names.empty();
+}
+
+
+void HostsTable::clear()
+{
+    _hosts.clear();
+    _names.clear();
+    _addresses.clear();
+}
+
+
+AsyncHostResolver::Backend HostsTable::backend(std::shared_ptr<const HostsTable> table,
+                                               AsyncHostResolver::Backend fallback)
+{
+    return [table, fallback](const AsyncHostResolver::Query& query) {
+        HostEntry hostEntry;
+        Poco::Net::IPAddress address;
+
+        if (table)
+        {
+            switch (query.type)
+            {
+                case AsyncHostResolver::QueryType::HOST_BY_NAME:
+                    if (table->findByName(query.host, hostEntry))
+                        return hostEntry;
+                    break;
+                case AsyncHostResolver::QueryType::HOST_BY_ADDRESS:
+                    if (Poco::Net::IPAddress::tryParse(query.host, address)
+                    && table->findByAddress(address, hostEntry))
+                        return hostEntry;
+                    break;
+                case AsyncHostResolver::QueryType::RESOLVE:
+                    if (Poco::Net::IPAddress::tryParse(query.host, address)
+                        ? table->findByAddress(address, hostEntry)
+                        : table->findByName(query.host, hostEntry))
+                        return hostEntry;
+                    break;
+                case AsyncHostResolver::QueryType::THIS_HOST:
+                    break;
+            }
+        }
+
+        if (fallback)
+            return fallback(query);
+
+        throw Poco::Net::HostNotFoundException(query.host);
+    };
+}
+
+
+void HostsTable::update(Host& host)
+{
+    // Build the entry from an addrinfo list, as the system resolver does.
+    const std::size_t count = host.addresses.size();
+    std::vector<struct addrinfo> infos(count);
+    std::vector<struct sockaddr_storage> storage(count);
+    std::vector<char> canonicalName(host.name.begin(), host.name.end());
+    canonicalName.push_back('\0');
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Poco::Net::IPAddress& address = host.addresses[i];
+        struct addrinfo& info = infos[i];
+
+        std::memset(&info, 0, sizeof(info));
+        std::memset(&storage[i], 0, sizeof(storage[i]));
+
+        if (address.family() == Poco::Net::IPAddress::IPv4)
+        {
+            struct sockaddr_in* sin = reinterpret_cast<struct sockaddr_in*>(&storage[i]);
+            sin->sin_family = AF_INET;
+            std::memcpy(&sin->sin_addr, address.addr(), sizeof(sin->sin_addr));
+            info.ai_family = AF_INET;
+            info.ai_addrlen = sizeof(struct sockaddr_in);
+        }
+        else
+        {
+            struct sockaddr_in6* sin6 = reinterpret_cast<struct sockaddr_in6*>(&storage[i]);
+            sin6->sin6_family = AF_INET6;
+            std::memcpy(&sin6->sin6_addr, address.addr(), sizeof(sin6->sin6_addr));
+            sin6->sin6_scope_id = address.scope();
+            info.ai_family = AF_INET6;
+            info.ai_addrlen = sizeof(struct sockaddr_in6);
+        }
+
+        info.ai_addr = reinterpret_cast<struct sockaddr*>(&storage[i]);
+        info.ai_next = i + 1 < count ? &infos[i + 1] : nullptr;
+    }
+
+    if (count == 0)
+    {
+        host.hostEntry = HostEntry();
+        return;
+    }
+
+    infos[0].ai_canonname = canonicalName.data();
+    host.hostEntry = HostEntry(&infos[0]);
+}
+
+
+std::string HostsTable::toKey(const std::string& name)
+{
+    std::string key = name;
+
+    // A fully qualified name may end with the root label.
+    if (!key.empty() && key.back() == '.')
+        key.pop_back();
+
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+
+    return key;
+}
+
+
+} } // namespace ofx::Net
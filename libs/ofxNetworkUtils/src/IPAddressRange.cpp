@@ -6,9 +6,10 @@
 
 
 #include "ofx/Net/IPAddressRange.h"
-#include "Poco/Net/NetException.h"
-#include "Poco/NumberParser.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include "ofx/Net/IPAddressRangeParser.h"
 #include "ofLog.h"
 
 
@@ -22,57 +23,66 @@ const Poco::Net::IPAddress IPAddressRange::MAXIMUM_PREFIX_IPV6(128, Poco::Net::I
 #endif
 
 
-IPAddressRange::IPAddressRange():
-    _address(Poco::Net::IPAddress::IPv4),
-    _mask(maximumPrefixIPAddress(Poco::Net::IPAddress::IPv4)),
-    _subnet(bitwiseOp(_address, _mask, BitwiseOp::AND))
+IPAddressRange::IPAddressRange()
 {
 }
 
 
 IPAddressRange::IPAddressRange(const std::string& CIDR)
 {
-    std::size_t position = CIDR.find("/");
+    const char* first = CIDR.data();
+    const char* last = first + CIDR.size();
+    const char* slash = static_cast<const char*>(std::memchr(first, '/', CIDR.size()));
 
-    if (!Poco::Net::IPAddress::tryParse(CIDR.substr(0, position), _address))
-    {
-        ofLogError("IPAddressRange::IPAddressRange") << "Unable to parse address: " << CIDR;
-        _address = Poco::Net::IPAddress();
-    }
-
-    unsigned prefix = maximumPrefix(_address.family());
+    CompactIPAddress address;
 
-    if (position != std::string::npos)
+    if (IPAddressRangeParser::parseAddress(first, slash ? slash : last, address) != IPAddressRangeParser::Error::NONE)
     {
-        std::string prefixString = CIDR.substr(position + 1);
+        // Fall back to Poco for the forms the strict parser rejects, such as
+        // the inet_aton short forms "10.1" and "10".
+        Poco::Net::IPAddress pocoAddress;
 
-        if (!Poco::NumberParser::tryParseUnsigned(prefixString,
-                                                  prefix) || prefix > maximumPrefix(_address.family()))
+        if (Poco::Net::IPAddress::tryParse(std::string(first, slash ? slash : last), pocoAddress))
         {
-            prefix = maximumPrefix(_address.family());
-            ofLogError("IPAddressRange::IPAddressRange") << "Invalid prefix CIDR prefix: " << prefixString << ", using " << prefix;
+            address = CompactIPAddress(pocoAddress);
+        }
+        else
+        {
+            ofLogError("IPAddressRange::IPAddressRange") << "Unable to parse address: " << CIDR;
+            address = CompactIPAddress();
         }
     }
 
-    _mask = Poco::Net::IPAddress(prefix, _address.family());
-    _subnet = bitwiseOp(_address, _mask, BitwiseOp::AND);
+    unsigned prefix = address.bitLength();
+
+    if (slash && IPAddressRangeParser::parsePrefix(slash + 1, last, address.bitLength(), prefix) != IPAddressRangeParser::Error::NONE)
+    {
+        ofLogError("IPAddressRange::IPAddressRange") << "Invalid prefix CIDR prefix: " << std::string(slash + 1, last) << ", using " << prefix;
+    }
 
+    _range = CompactIPAddressRange(address, prefix);
 }
 
 
 IPAddressRange::IPAddressRange(const Poco::Net::IPAddress& address):
-    _address(address),
-    _mask(maximumPrefixIPAddress(_address.family())),
-    _subnet(bitwiseOp(_address, _mask, BitwiseOp::AND))
+    _range(CompactIPAddress(address))
 {
 }
 
 
 IPAddressRange::IPAddressRange(const Poco::Net::IPAddress& address,
                                unsigned prefix):
-    _address(address),
-    _mask(prefix, _address.family()),
-    _subnet(bitwiseOp(_address, _mask, BitwiseOp::AND))
+    _range(CompactIPAddress(address), prefix)
+{
+    if (prefix > maximumPrefix(address.family()))
+    {
+        ofLogError("IPAddressRange::IPAddressRange") << "Invalid prefix: " << prefix << ", using " << _range.prefix();
+    }
+}
+
+
+IPAddressRange::IPAddressRange(const CompactIPAddressRange& range):
+    _range(range)
 {
 }
 
@@ -84,59 +94,49 @@ IPAddressRange::~IPAddressRange()
 
 Poco::Net::IPAddress IPAddressRange::getAddress() const
 {
-    return _address;
+    return address();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::getSubnet() const
 {
-    return _subnet;
+    return subnet();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::getMask() const
 {
-    return _mask;
+    return mask();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::address() const
 {
-    return _address;
+    return _range.address().toIPAddress();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::subnet() const
 {
-    return _subnet;
+    return _range.subnet().toIPAddress();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::mask() const
 {
-    return _mask;
+    return _range.mask().toIPAddress();
 }
 
 
 bool IPAddressRange::contains(const IPAddressRange& range) const
 {
-    // TODO: this could be more efficient.
-    return maskPrefixLength() <= range.maskPrefixLength()
-        && contains(range.hostMin())
-        && contains(range.hostMax());
+    return _range.contains(range._range);
 }
 
 
 bool IPAddressRange::contains(const Poco::Net::IPAddress& address) const
 {
-    if (address.family() != _address.family())
-    {
-        return false;
-    }
-    else
-    {
-        return _subnet == bitwiseOp(address, _mask, BitwiseOp::AND);
-    }
+    return _range.contains(CompactIPAddress(address));
 }
 
 
@@ -166,31 +166,63 @@ Poco::Net::IPAddress IPAddressRange::getHostMin() const
 
 unsigned IPAddressRange::maskPrefixLength() const
 {
-    return _mask.prefixLength();
+    return _range.prefix();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::wildcardMask() const
 {
-    return bitwiseOp(maximumPrefixIPAddress(_subnet.family()), _mask, BitwiseOp::XOR);
+    return _range.wildcardMask().toIPAddress();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::hostMax() const
 {
-    return bitwiseOp(_address, wildcardMask(), BitwiseOp::OR);
+    return _range.hostMax().toIPAddress();
 }
 
 
 Poco::Net::IPAddress IPAddressRange::hostMin() const
 {
-    return _subnet;
+    return _range.hostMin().toIPAddress();
+}
+
+
+IPAddressSequence<CompactIPAddress> IPAddressRange::hosts() const
+{
+    return strided(1);
+}
+
+
+IPAddressSequence<CompactIPAddress> IPAddressRange::strided(uint64_t stride) const
+{
+    return strided(IPAddressBits{ 0, stride });
+}
+
+
+IPAddressSequence<CompactIPAddress> IPAddressRange::strided(const IPAddressBits& stride) const
+{
+    return IPAddressSequence<CompactIPAddress>(_range, _range.address().bitLength(), stride);
+}
+
+
+IPAddressSequence<CompactIPAddressRange> IPAddressRange::subnets(unsigned prefix) const
+{
+    const unsigned length = _range.address().bitLength();
+    prefix = std::min(prefix, length);
+    return IPAddressSequence<CompactIPAddressRange>(_range, prefix, IPAddressBits{ 0, 1 }.shiftLeft(length - prefix));
 }
 
 
 Poco::Net::IPAddress::Family IPAddressRange::family() const
 {
-    return _address.family();
+    return _range.address().isIPv6() ? Poco::Net::IPAddress::IPv6 : Poco::Net::IPAddress::IPv4;
+}
+
+
+const CompactIPAddressRange& IPAddressRange::compact() const
+{
+    return _range;
 }
 
 
@@ -198,9 +230,9 @@ std::string IPAddressRange::toString() const
 {
     std::stringstream ss;
 
-    ss << _address.toString();
+    ss << _range.address().toString();
     ss << "/";
-    ss << _mask.prefixLength();
+    ss << _range.prefix();
 
     return ss.str();
 }
@@ -208,9 +240,7 @@ std::string IPAddressRange::toString() const
 
 bool IPAddressRange::operator == (const IPAddressRange& range) const
 {
-    return _address == range._address &&
-           _subnet == range._subnet &&
-           _mask == range._mask;
+    return _range == range._range;
 }
 
 
@@ -222,9 +252,7 @@ bool IPAddressRange::operator != (const IPAddressRange& range) const
 
 bool IPAddressRange::operator < (const IPAddressRange& range) const
 {
-    return _address < range._address &&
-           _subnet < range._subnet &&
-           _mask < range._mask;
+    return _range < range._range;
 }
 
 
@@ -265,81 +293,4 @@ unsigned IPAddressRange::maximumPrefix(Poco::Net::IPAddress::Family family)
 }
 
 
-const Poco::Net::IPAddress& IPAddressRange::maximumPrefixIPAddress(Poco::Net::IPAddress::Family family)
-{
-    switch (family)
-    {
-        case Poco::Net::IPAddress::IPv4:
-            return MAXIMUM_PREFIX_IPV4;
-#ifdef POCO_HAVE_IPv6
-        case Poco::Net::IPAddress::IPv6:
-            return MAXIMUM_PREFIX_IPV6;
-#endif
-        default:
-            return MAXIMUM_PREFIX_IPV4;
-    }
-
-    ofLogWarning("IPAddressRange::maximumPrefixIPAddress") << "Unknown IPAddress family.";
-    return MAXIMUM_PREFIX_IPV4;
-}
-
-
-
-Poco::Net::IPAddress IPAddressRange::bitwiseOp(const Poco::Net::IPAddress& address,
-                                               const Poco::Net::IPAddress& mask,
-                                               BitwiseOp op)
-{
-    try
-    {
-        if (address.family() == Poco::Net::IPAddress::Family::IPv6 &&
-            mask.family() == Poco::Net::IPAddress::Family::IPv6)
-        {
-            if (address.scope() != mask.scope())
-                throw Poco::InvalidArgumentException("Scope ID of passed IPv6 address does not match with the source one.");
-
-            const Poco::Net::Impl::IPv6AddressImpl t(address.addr(), address.scope());
-            const Poco::Net::Impl::IPv6AddressImpl o(mask.addr(), mask.scope());
-            Poco::Net::Impl::IPv6AddressImpl result;
-
-            switch (op)
-            {
-                case BitwiseOp::AND:
-                    result = t & o;
-                    break;
-                case BitwiseOp::OR:
-                    result = t | o;
-                    break;
-                case BitwiseOp::XOR:
-                    result = t ^ o;
-                    break;
-            }
-
-            return Poco::Net::IPAddress(result.addr(), result.length(), result.scope());
-
-        }
-        else
-        {
-            // This will throw an exception if in compatible mask / address.
-            switch (op)
-            {
-                case BitwiseOp::AND:
-                    return address & mask;
-                case BitwiseOp::OR:
-                    return address | mask;
-                case BitwiseOp::XOR:
-                    return address ^ mask;
-            }
-        }
-    }
-    catch (const Poco::InvalidArgumentException& exc)
-    {
-        ofLogError("IPAddressRange::bitwiseOp") << exc.displayText();
-        return Poco::Net::IPAddress();
-    }
-
-    ofLogError("IPAddressRange::bitwiseOp") << "At end of function, this should not happen.";
-    return Poco::Net::IPAddress();
-}
-
-
 } } // namespace ofx::Net
@@ -0,0 +1,522 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/IPAddressRangeBatch.h"
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OFX_NET_BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+
+// GCC and Clang need the instruction set enabled per function so that the
+// rest of the addon can be built without -mavx2.
+#if defined(OFX_NET_BATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define OFX_NET_BATCH_TARGET(isa) __attribute__((target(isa)))
+#else
+#define OFX_NET_BATCH_TARGET(isa)
+#endif
+
+
+namespace ofx {
+namespace Net {
+
+
+namespace {
+
+
+/// \brief An IPv4 mask and network in network byte order.
+struct IPv4Key
+{
+    uint32_t mask;
+    uint32_t network;
+};
+
+
+/// \brief An IPv6 mask and network in network byte order.
+struct IPv6Key
+{
+    uint8_t mask[16];
+    uint8_t network[16];
+};
+
+
+typedef uint64_t (*IPv4Kernel)(const IPv4Key& key, const uint32_t* addresses, std::size_t count);
+typedef uint64_t (*IPv6Kernel)(const IPv6Key& key, const uint8_t* addresses, std::size_t count);
+
+
+IPv4Key makeIPv4Key(const CompactIPAddressRange& range)
+{
+    IPv4Key key;
+
+    if (range.family() == CompactIPAddress::IPv4)
+    {
+        std::memcpy(&key.mask, range.mask().bytes(), 4);
+        std::memcpy(&key.network, range.subnet().bytes(), 4);
+    }
+    else
+    {
+        // A network bit outside of the mask never matches.
+        key.mask = 0;
+        key.network = ~uint32_t(0);
+    }
+
+    return key;
+}
+
+
+IPv6Key makeIPv6Key(const CompactIPAddressRange& range)
+{
+    IPv6Key key;
+
+    if (range.family() == CompactIPAddress::IPv6)
+    {
+        std::memcpy(key.mask, range.mask().bytes(), 16);
+        std::memcpy(key.network, range.subnet().bytes(), 16);
+    }
+    else
+    {
+        std::memset(key.mask, 0, 16);
+        std::memset(key.network, 0xFF, 16);
+    }
+
+    return key;
+}
+
+
+unsigned popCount(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(value));
+#else
+    unsigned result = 0;
+
+    while (value)
+    {
+        value &= value - 1;
+        ++result;
+    }
+
+    return result;
+#endif
+}
+
+
+uint64_t scalarIPv4(const IPv4Key& key, const uint32_t* addresses, std::size_t count)
+{
+    uint64_t word = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+        word |= uint64_t((addresses[i] & key.mask) == key.network) << i;
+
+    return word;
+}
+
+
+uint64_t scalarIPv6(const IPv6Key& key, const uint8_t* addresses, std::size_t count)
+{
+    uint64_t mask[2];
+    uint64_t network[2];
+    std::memcpy(mask, key.mask, 16);
+    std::memcpy(network, key.network, 16);
+
+    uint64_t word = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        uint64_t address[2];
+        std::memcpy(address, addresses + 16 * i, 16);
+
+        const uint64_t diff = ((address[0] & mask[0]) ^ network[0])
+                            | ((address[1] & mask[1]) ^ network[1]);
+
+        word |= uint64_t(diff == 0) << i;
+    }
+
+    return word;
+}
+
+
+#if defined(OFX_NET_BATCH_X86)
+
+
+OFX_NET_BATCH_TARGET("sse2")
+uint64_t sse2IPv4(const IPv4Key& key, const uint32_t* addresses, std::size_t count)
+{
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(key.mask));
+    const __m128i network = _mm_set1_epi32(static_cast<int>(key.network));
+
+    uint64_t word = 0;
+    std::size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i address = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addresses + i));
+        __m128i equal = _mm_cmpeq_epi32(_mm_and_si128(address, mask), network);
+        word |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(equal))) << i;
+    }
+
+    if (i < count)
+        word |= scalarIPv4(key, addresses + i, count - i) << i;
+
+    return word;
+}
+
+
+OFX_NET_BATCH_TARGET("sse2")
+uint64_t sse2IPv6(const IPv6Key& key, const uint8_t* addresses, std::size_t count)
+{
+    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.mask));
+    const __m128i network = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.network));
+
+    uint64_t word = 0;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        __m128i address = _mm_loadu_si128(reinterpret_cast<const __m128i*>(addresses + 16 * i));
+        __m128i equal = _mm_cmpeq_epi8(_mm_and_si128(address, mask), network);
+        word |= uint64_t(_mm_movemask_epi8(equal) == 0xFFFF) << i;
+    }
+
+    return word;
+}
+
+
+OFX_NET_BATCH_TARGET("avx2")
+uint64_t avx2IPv4(const IPv4Key& key, const uint32_t* addresses, std::size_t count)
+{
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(key.mask));
+    const __m256i network = _mm256_set1_epi32(static_cast<int>(key.network));
+
+    uint64_t word = 0;
+    std::size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i address = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(addresses + i));
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_and_si256(address, mask), network);
+        word |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) << i;
+    }
+
+    if (i < count)
+        word |= scalarIPv4(key, addresses + i, count - i) << i;
+
+    return word;
+}
+
+
+OFX_NET_BATCH_TARGET("avx2")
+uint64_t avx2IPv6(const IPv6Key& key, const uint8_t* addresses, std::size_t count)
+{
+    const __m128i mask128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.mask));
+    const __m128i network128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.network));
+    const __m256i mask = _mm256_inserti128_si256(_mm256_castsi128_si256(mask128), mask128, 1);
+    const __m256i network = _mm256_inserti128_si256(_mm256_castsi128_si256(network128), network128, 1);
+
+    uint64_t word = 0;
+    std::size_t i = 0;
+
+    // Two addresses per register.
+    for (; i + 2 <= count; i += 2)
+    {
+        __m256i address = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(addresses + 16 * i));
+        __m256i equal = _mm256_cmpeq_epi8(_mm256_and_si256(address, mask), network);
+        const uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+        word |= uint64_t((bits & 0xFFFF) == 0xFFFF) << i;
+        word |= uint64_t((bits >> 16) == 0xFFFF) << (i + 1);
+    }
+
+    if (i < count)
+        word |= scalarIPv6(key, addresses + 16 * i, count - i) << i;
+
+    return word;
+}
+
+
+#endif
+
+
+bool cpuSupportsAVX2()
+{
+#if defined(OFX_NET_BATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(OFX_NET_BATCH_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+
+    // The OS must save the AVX state (OSXSAVE and AVX bits).
+    const int osxsaveAndAVX = (1 << 27) | (1 << 28);
+
+    if ((info[2] & osxsaveAndAVX) != osxsaveAndAVX || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+
+bool cpuSupportsSSE2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(OFX_NET_BATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#elif defined(OFX_NET_BATCH_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return false;
+#endif
+}
+
+
+std::atomic<int>& currentKernel()
+{
+    static std::atomic<int> kernel(static_cast<int>(IPAddressRangeBatch::bestKernel()));
+    return kernel;
+}
+
+
+IPv4Kernel ipv4Kernel()
+{
+#if defined(OFX_NET_BATCH_X86)
+    switch (static_cast<IPAddressRangeBatch::Kernel>(currentKernel().load(std::memory_order_relaxed)))
+    {
+        case IPAddressRangeBatch::Kernel::AVX2:
+            return avx2IPv4;
+        case IPAddressRangeBatch::Kernel::SSE2:
+            return sse2IPv4;
+        case IPAddressRangeBatch::Kernel::SCALAR:
+            return scalarIPv4;
+    }
+#endif
+    return scalarIPv4;
+}
+
+
+IPv6Kernel ipv6Kernel()
+{
+#if defined(OFX_NET_BATCH_X86)
+    switch (static_cast<IPAddressRangeBatch::Kernel>(currentKernel().load(std::memory_order_relaxed)))
+    {
+        case IPAddressRangeBatch::Kernel::AVX2:
+            return avx2IPv6;
+        case IPAddressRangeBatch::Kernel::SSE2:
+            return sse2IPv6;
+        case IPAddressRangeBatch::Kernel::SCALAR:
+            return scalarIPv6;
+    }
+#endif
+    return scalarIPv6;
+}
+
+
+/// \brief Run a kernel over 64-address blocks and write the bitmap.
+template<typename Key, typename Address, typename Kernel>
+std::size_t fillBitmap(Kernel kernel,
+                       const Key& key,
+                       const Address* addresses,
+                       std::size_t stride,
+                       std::size_t count,
+                       uint64_t* bitmap)
+{
+    std::size_t matches = 0;
+
+    for (std::size_t i = 0; i < count; i += 64)
+    {
+        const std::size_t blockSize = count - i < 64 ? count - i : 64;
+        const uint64_t word = kernel(key, addresses + i * stride, blockSize);
+        bitmap[i / 64] = word;
+        matches += popCount(word);
+    }
+
+    return matches;
+}
+
+
+/// \brief Run a kernel for each range over 64-address blocks and write the
+/// first matching range index per address.
+template<typename Key, typename Address, typename Kernel>
+std::size_t fillIndices(Kernel kernel,
+                        const std::vector<Key>& keys,
+                        const Address* addresses,
+                        std::size_t stride,
+                        std::size_t count,
+                        int32_t* indices)
+{
+    std::size_t matches = 0;
+
+    for (std::size_t i = 0; i < count; i += 64)
+    {
+        const std::size_t blockSize = count - i < 64 ? count - i : 64;
+        const uint64_t all = blockSize == 64 ? ~uint64_t(0) : (uint64_t(1) << blockSize) - 1;
+        uint64_t remaining = all;
+
+        for (std::size_t r = 0; r < keys.size() && remaining; ++r)
+        {
+            uint64_t word = kernel(keys[r], addresses + i * stride, blockSize) & remaining;
+            remaining &= ~word;
+
+            while (word)
+            {
+                const unsigned bit = 63 - IPAddressBits::countLeadingZeros64(word & (~word + 1));
+                indices[i + bit] = static_cast<int32_t>(r);
+                word &= word - 1;
+            }
+        }
+
+        matches += popCount(all & ~remaining);
+
+        while (remaining)
+        {
+            const unsigned bit = 63 - IPAddressBits::countLeadingZeros64(remaining & (~remaining + 1));
+            indices[i + bit] = IPAddressRangeBatch::NO_MATCH;
+            remaining &= remaining - 1;
+        }
+    }
+
+    return matches;
+}
+
+
+} // namespace
+
+
+std::size_t IPAddressRangeBatch::containsIPv4(const CompactIPAddressRange& range,
+                                              const uint32_t* addresses,
+                                              std::size_t count,
+                                              uint64_t* bitmap)
+{
+    return fillBitmap(ipv4Kernel(), makeIPv4Key(range), addresses, 1, count, bitmap);
+}
+
+
+std::size_t IPAddressRangeBatch::containsIPv6(const CompactIPAddressRange& range,
+                                              const uint8_t* addresses,
+                                              std::size_t count,
+                                              uint64_t* bitmap)
+{
+    return fillBitmap(ipv6Kernel(), makeIPv6Key(range), addresses, 16, count, bitmap);
+}
+
+
+std::size_t IPAddressRangeBatch::matchIPv4(const CompactIPAddressRange* ranges,
+                                           std::size_t rangeCount,
+                                           const uint32_t* addresses,
+                                           std::size_t count,
+                                           int32_t* indices)
+{
+    std::vector<IPv4Key> keys;
+    keys.reserve(rangeCount);
+
+    for (std::size_t r = 0; r < rangeCount; ++r)
+        keys.push_back(makeIPv4Key(ranges[r]));
+
+    return fillIndices(ipv4Kernel(), keys, addresses, 1, count, indices);
+}
+
+
+std::size_t IPAddressRangeBatch::matchIPv6(const CompactIPAddressRange* ranges,
+                                           std::size_t rangeCount,
+                                           const uint8_t* addresses,
+                                           std::size_t count,
+                                           int32_t* indices)
+{
+    std::vector<IPv6Key> keys;
+    keys.reserve(rangeCount);
+
+    for (std::size_t r = 0; r < rangeCount; ++r)
+        keys.push_back(makeIPv6Key(ranges[r]));
+
+    return fillIndices(ipv6Kernel(), keys, addresses, 16, count, indices);
+}
+
+
+std::size_t IPAddressRangeBatch::bitmapSize(std::size_t count)
+{
+    return (count + 63) / 64;
+}
+
+
+IPAddressRangeBatch::Kernel IPAddressRangeBatch::kernel()
+{
+    return static_cast<Kernel>(currentKernel().load());
+}
+
+
+bool IPAddressRangeBatch::setKernel(Kernel kernel)
+{
+    if (!isSupported(kernel))
+        return false;
+
+    currentKernel().store(static_cast<int>(kernel));
+    return true;
+}
+
+
+bool IPAddressRangeBatch::isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::AVX2:
+            return cpuSupportsAVX2();
+        case Kernel::SSE2:
+            return cpuSupportsSSE2();
+        case Kernel::SCALAR:
+            return true;
+    }
+
+    return false;
+}
+
+
+IPAddressRangeBatch::Kernel IPAddressRangeBatch::bestKernel()
+{
+    if (cpuSupportsAVX2())
+        return Kernel::AVX2;
+    else if (cpuSupportsSSE2())
+        return Kernel::SSE2;
+    else
+        return Kernel::SCALAR;
+}
+
+
+std::string IPAddressRangeBatch::toString(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::AVX2:
+            return "AVX2";
+        case Kernel::SSE2:
+            return "SSE2";
+        case Kernel::SCALAR:
+            return "SCALAR";
+    }
+
+    return "UNKNOWN";
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,451 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/IPAddressRangeParser.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "ofUtils.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+namespace {
+
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    else if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    else
+        return -1;
+}
+
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+/// \brief Parse a dotted-quad IPv4 address.
+/// \param p The current position, advanced past the address on success.
+/// \param last One past the last character.
+/// \param bytes The four output bytes.
+/// \returns true on success.
+bool parseIPv4(const char*& p, const char* last, uint8_t* bytes)
+{
+    for (int part = 0; part < 4; ++part)
+    {
+        if (part > 0)
+        {
+            if (p == last || *p != '.')
+                return false;
+
+            ++p;
+        }
+
+        unsigned value = 0;
+        int digits = 0;
+
+        while (p != last && *p >= '0' && *p <= '9' && digits < 3)
+        {
+            value = value * 10 + static_cast<unsigned>(*p - '0');
+            ++digits;
+            ++p;
+        }
+
+        if (digits == 0 || value > 255)
+            return false;
+
+        bytes[part] = static_cast<uint8_t>(value);
+    }
+
+    return true;
+}
+
+
+/// \brief Parse an IPv6 address with optional :: compression, embedded IPv4
+/// suffix and zone id.
+/// \param p The current position, advanced to the error location on failure.
+/// \param last One past the last character.
+/// \param bytes The sixteen output bytes.
+/// \returns true on success.
+bool parseIPv6(const char*& p, const char* last, uint8_t* bytes)
+{
+    uint16_t groups[8] = { 0 };
+    int count = 0;
+    int gap = -1;
+
+    if (p != last && *p == ':')
+    {
+        if (p + 1 == last || p[1] != ':')
+            return false;
+
+        gap = 0;
+        p += 2;
+    }
+
+    while (p != last && *p != '%')
+    {
+        const char* start = p;
+        unsigned value = 0;
+        int digits = 0;
+
+        while (p != last && digits < 4 && hexValue(*p) >= 0)
+        {
+            value = (value << 4) | static_cast<unsigned>(hexValue(*p));
+            ++digits;
+            ++p;
+        }
+
+        if (digits == 0)
+            return false;
+
+        if (p != last && *p == '.')
+        {
+            // An embedded IPv4 address fills the last two groups.
+            p = start;
+            uint8_t ipv4[4];
+
+            if (count > 6 || !parseIPv4(p, last, ipv4))
+                return false;
+
+            groups[count++] = static_cast<uint16_t>((ipv4[0] << 8) | ipv4[1]);
+            groups[count++] = static_cast<uint16_t>((ipv4[2] << 8) | ipv4[3]);
+            break;
+        }
+
+        if (count == 8)
+            return false;
+
+        groups[count++] = static_cast<uint16_t>(value);
+
+        if (p == last || *p == '%')
+            break;
+
+        if (*p != ':')
+            return false;
+
+        ++p;
+
+        if (p != last && *p == ':')
+        {
+            if (gap >= 0)
+                return false;
+
+            gap = count;
+            ++p;
+        }
+        else if (p == last || *p == '%')
+        {
+            // A single trailing colon.
+            return false;
+        }
+    }
+
+    if (p != last && *p == '%')
+    {
+        // The zone id is accepted but not stored.
+        if (p + 1 == last)
+            return false;
+
+        p = last;
+    }
+
+    if (p != last)
+        return false;
+
+    if (gap < 0 && count != 8)
+        return false;
+
+    if (gap >= 0 && count > 7)
+        return false;
+
+    uint16_t expanded[8] = { 0 };
+
+    if (gap < 0)
+    {
+        std::memcpy(expanded, groups, sizeof(groups));
+    }
+    else
+    {
+        const int tail = count - gap;
+
+        for (int i = 0; i < gap; ++i)
+            expanded[i] = groups[i];
+
+        for (int i = 0; i < tail; ++i)
+            expanded[8 - tail + i] = groups[gap + i];
+    }
+
+    for (int i = 0; i < 8; ++i)
+    {
+        bytes[2 * i] = static_cast<uint8_t>(expanded[i] >> 8);
+        bytes[2 * i + 1] = static_cast<uint8_t>(expanded[i] & 0xFF);
+    }
+
+    return true;
+}
+
+
+} // namespace
+
+
+IPAddressRangeParser::Error IPAddressRangeParser::parseAddress(const char* first,
+                                                               const char* last,
+                                                               CompactIPAddress& address,
+                                                               const char** position)
+{
+    if (first == last)
+    {
+        if (position)
+            *position = first;
+
+        return Error::EMPTY;
+    }
+
+    const char* p = first;
+    uint8_t bytes[16];
+    bool success = false;
+    std::size_t length = 4;
+
+    if (std::memchr(first, ':', static_cast<std::size_t>(last - first)))
+    {
+        length = 16;
+        success = parseIPv6(p, last, bytes);
+    }
+    else
+    {
+        success = parseIPv4(p, last, bytes) && p == last;
+    }
+
+    if (!success)
+    {
+        if (position)
+            *position = p;
+
+        return Error::INVALID_ADDRESS;
+    }
+
+    address = CompactIPAddress(bytes, length);
+    return Error::NONE;
+}
+
+
+IPAddressRangeParser::Error IPAddressRangeParser::parsePrefix(const char* first,
+                                                              const char* last,
+                                                              unsigned maximumPrefix,
+                                                              unsigned& prefix,
+                                                              const char** position)
+{
+    const char* p = first;
+    unsigned value = 0;
+
+    while (p != last && *p >= '0' && *p <= '9')
+    {
+        // Saturate so that long digit strings cannot overflow.
+        value = std::min(value * 10 + static_cast<unsigned>(*p - '0'), maximumPrefix + 1);
+        ++p;
+    }
+
+    if (p == first || p != last)
+    {
+        if (position)
+            *position = p;
+
+        return p == first && p == last ? Error::EMPTY : Error::INVALID_PREFIX;
+    }
+
+    if (value > maximumPrefix)
+    {
+        if (position)
+            *position = first;
+
+        return Error::PREFIX_OUT_OF_RANGE;
+    }
+
+    prefix = value;
+    return Error::NONE;
+}
+
+
+IPAddressRangeParser::Error IPAddressRangeParser::parse(const char* first,
+                                                        const char* last,
+                                                        CompactIPAddressRange& range,
+                                                        const char** position)
+{
+    const char* slash = static_cast<const char*>(std::memchr(first, '/', static_cast<std::size_t>(last - first)));
+
+    CompactIPAddress address;
+    Error error = parseAddress(first, slash ? slash : last, address, position);
+
+    if (error != Error::NONE)
+        return error;
+
+    unsigned prefix = address.bitLength();
+
+    if (slash)
+    {
+        error = parsePrefix(slash + 1, last, address.bitLength(), prefix, position);
+
+        if (error == Error::EMPTY)
+            error = Error::INVALID_PREFIX;
+
+        if (error != Error::NONE)
+            return error;
+    }
+
+    range = CompactIPAddressRange(address, prefix);
+    return Error::NONE;
+}
+
+
+IPAddressRangeParser::Error IPAddressRangeParser::parse(const std::string& CIDR,
+                                                        CompactIPAddressRange& range)
+{
+    return parse(CIDR.data(), CIDR.data() + CIDR.size(), range);
+}
+
+
+std::size_t IPAddressRangeParser::load(const char* first,
+                                       const char* last,
+                                       IPAddressRange::List& ranges,
+                                       std::vector<LineError>* errors)
+{
+    std::size_t line = 1;
+    return loadLines(first, last, line, ranges, errors);
+}
+
+
+bool IPAddressRangeParser::loadFile(const std::string& path,
+                                    IPAddressRange::List& ranges,
+                                    std::vector<LineError>* errors)
+{
+    std::ifstream stream(ofToDataPath(path, true).c_str(), std::ios::binary);
+
+    if (!stream)
+        return false;
+
+    // Lines are parsed in place. A partial line at the end of a block is
+    // moved to the front of the buffer before the next read.
+    std::vector<char> buffer(64 * 1024);
+    std::size_t used = 0;
+    std::size_t line = 1;
+
+    while (stream)
+    {
+        stream.read(buffer.data() + used, static_cast<std::streamsize>(buffer.size() - used));
+        used += static_cast<std::size_t>(stream.gcount());
+
+        const char* first = buffer.data();
+        const char* last = first + used;
+        const char* end = last;
+
+        if (stream)
+        {
+            // Only consume complete lines until the end of the file.
+            while (end != first && end[-1] != '\n')
+                --end;
+
+            if (end == first)
+            {
+                // A single line longer than the buffer.
+                buffer.resize(buffer.size() * 2);
+                continue;
+            }
+        }
+
+        loadLines(first, end, line, ranges, errors);
+
+        used = static_cast<std::size_t>(last - end);
+        std::memmove(buffer.data(), end, used);
+    }
+
+    return !stream.bad();
+}
+
+
+std::string IPAddressRangeParser::toString(Error error)
+{
+    switch (error)
+    {
+        case Error::NONE:
+            return "NONE";
+        case Error::EMPTY:
+            return "EMPTY";
+        case Error::INVALID_ADDRESS:
+            return "INVALID_ADDRESS";
+        case Error::INVALID_PREFIX:
+            return "INVALID_PREFIX";
+        case Error::PREFIX_OUT_OF_RANGE:
+            return "PREFIX_OUT_OF_RANGE";
+    }
+
+    return "UNKNOWN";
+}
+
+
+std::size_t IPAddressRangeParser::loadLines(const char* first,
+                                            const char* last,
+                                            std::size_t& line,
+                                            IPAddressRange::List& ranges,
+                                            std::vector<LineError>* errors)
+{
+    std::size_t count = 0;
+
+    while (first != last)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+        const char* next = lineEnd ? lineEnd + 1 : last;
+
+        if (!lineEnd)
+            lineEnd = last;
+
+        const char* comment = static_cast<const char*>(std::memchr(first, '#', static_cast<std::size_t>(lineEnd - first)));
+
+        const char* begin = first;
+        const char* end = comment ? comment : lineEnd;
+
+        while (begin != end && isSpace(*begin))
+            ++begin;
+
+        while (end != begin && isSpace(end[-1]))
+            --end;
+
+        if (begin != end)
+        {
+            CompactIPAddressRange range;
+            const char* position = begin;
+            Error error = parse(begin, end, range, &position);
+
+            if (error == Error::NONE)
+            {
+                ranges.push_back(IPAddressRange(range));
+                ++count;
+            }
+            else if (errors)
+            {
+                errors->push_back({ line, static_cast<std::size_t>(position - first) + 1, error });
+            }
+        }
+
+        first = next;
+        ++line;
+    }
+
+    return count;
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,260 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/IPAddressRangeUtils.h"
+#include <algorithm>
+#include <vector>
+
+
+namespace ofx {
+namespace Net {
+
+
+namespace {
+
+
+/// \brief An inclusive interval of addresses stored as numeric values.
+struct Interval
+{
+    CompactIPAddress::Family family;
+    IPAddressBits first;
+    IPAddressBits last;
+
+    bool operator < (const Interval& other) const
+    {
+        if (family != other.family)
+            return family < other.family;
+
+        return first < other.first;
+    }
+};
+
+
+const IPAddressBits ONE = { 0, 1 };
+
+
+unsigned bitLength(CompactIPAddress::Family family)
+{
+    return CompactIPAddress::maximumPrefix(family);
+}
+
+
+IPAddressBits toValue(const CompactIPAddress& address)
+{
+    return address.bits().shiftRight(128 - address.bitLength());
+}
+
+
+CompactIPAddress toAddress(const IPAddressBits& value,
+                           CompactIPAddress::Family family)
+{
+    return CompactIPAddress(value.shiftLeft(128 - bitLength(family)), family);
+}
+
+
+/// \brief Convert ranges to sorted, disjoint, non-adjacent intervals.
+std::vector<Interval> toIntervals(const IPAddressRange::List& ranges)
+{
+    std::vector<Interval> intervals;
+    intervals.reserve(ranges.size());
+
+    for (const auto& range: ranges)
+    {
+        const CompactIPAddressRange& compact = range.compact();
+        Interval interval = { compact.family(),
+                              toValue(compact.hostMin()),
+                              toValue(compact.hostMax()) };
+        intervals.push_back(interval);
+    }
+
+    std::sort(intervals.begin(), intervals.end());
+
+    std::vector<Interval> merged;
+    merged.reserve(intervals.size());
+
+    for (const auto& interval: intervals)
+    {
+        if (!merged.empty() && merged.back().family == interval.family)
+        {
+            Interval& back = merged.back();
+
+            if (interval.first <= back.last || interval.first - back.last == ONE)
+            {
+                if (back.last < interval.last)
+                    back.last = interval.last;
+
+                continue;
+            }
+        }
+
+        merged.push_back(interval);
+    }
+
+    return merged;
+}
+
+
+/// \brief Append the minimal CIDR cover of an interval.
+void appendRanges(const Interval& interval, IPAddressRange::List& ranges)
+{
+    const unsigned length = bitLength(interval.family);
+    IPAddressBits first = interval.first;
+
+    while (true)
+    {
+        // The block must be aligned to first and must not extend past last.
+        unsigned alignment = std::min(first.countTrailingZeros(), length);
+
+        IPAddressBits count = interval.last - first + ONE;
+        unsigned fit = count.isZero() ? 128 : 127 - count.countLeadingZeros();
+
+        unsigned hostBits = std::min(alignment, fit);
+
+        ranges.push_back(IPAddressRange(CompactIPAddressRange(toAddress(first, interval.family),
+                                                              length - hostBits)));
+
+        IPAddressBits blockLast = first + ONE.shiftLeft(hostBits) - ONE;
+
+        if (blockLast == interval.last)
+            break;
+
+        first = blockLast + ONE;
+    }
+}
+
+
+IPAddressRange::List toRanges(const std::vector<Interval>& intervals)
+{
+    IPAddressRange::List ranges;
+    ranges.reserve(intervals.size());
+
+    for (const auto& interval: intervals)
+        appendRanges(interval, ranges);
+
+    return ranges;
+}
+
+
+} // namespace
+
+
+IPAddressRange::List IPAddressRangeUtils::normalize(const IPAddressRange::List& ranges)
+{
+    return toRanges(toIntervals(ranges));
+}
+
+
+IPAddressRange::List IPAddressRangeUtils::unite(const IPAddressRange::List& a,
+                                                const IPAddressRange::List& b)
+{
+    IPAddressRange::List all;
+    all.reserve(a.size() + b.size());
+    all.insert(all.end(), a.begin(), a.end());
+    all.insert(all.end(), b.begin(), b.end());
+    return normalize(all);
+}
+
+
+IPAddressRange::List IPAddressRangeUtils::intersect(const IPAddressRange::List& a,
+                                                    const IPAddressRange::List& b)
+{
+    std::vector<Interval> left = toIntervals(a);
+    std::vector<Interval> right = toIntervals(b);
+    std::vector<Interval> result;
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    while (i < left.size() && j < right.size())
+    {
+        const Interval& l = left[i];
+        const Interval& r = right[j];
+
+        if (l.family != r.family)
+        {
+            if (l.family < r.family)
+                ++i;
+            else
+                ++j;
+
+            continue;
+        }
+
+        const IPAddressBits first = l.first < r.first ? r.first : l.first;
+        const IPAddressBits last = l.last < r.last ? l.last : r.last;
+
+        if (first <= last)
+        {
+            Interval interval = { l.family, first, last };
+            result.push_back(interval);
+        }
+
+        // Advance whichever interval ends first.
+        if (l.last < r.last)
+            ++i;
+        else
+            ++j;
+    }
+
+    return toRanges(result);
+}
+
+
+IPAddressRange::List IPAddressRangeUtils::subtract(const IPAddressRange::List& a,
+                                                   const IPAddressRange::List& b)
+{
+    std::vector<Interval> left = toIntervals(a);
+    std::vector<Interval> right = toIntervals(b);
+    std::vector<Interval> result;
+
+    std::size_t j = 0;
+
+    for (const auto& interval: left)
+    {
+        Interval remaining = interval;
+        bool empty = false;
+
+        // Skip subtrahends that end before this interval starts.
+        while (j < right.size() && (right[j].family < remaining.family ||
+                                    (right[j].family == remaining.family && right[j].last < remaining.first)))
+        {
+            ++j;
+        }
+
+        std::size_t k = j;
+
+        while (k < right.size() && right[k].family == remaining.family && right[k].first <= remaining.last)
+        {
+            const Interval& r = right[k];
+
+            if (remaining.first < r.first)
+            {
+                Interval before = { remaining.family, remaining.first, r.first - ONE };
+                result.push_back(before);
+            }
+
+            if (r.last < remaining.last)
+            {
+                remaining.first = r.last + ONE;
+                ++k;
+            }
+            else
+            {
+                empty = true;
+                break;
+            }
+        }
+
+        if (!empty)
+            result.push_back(remaining);
+    }
+
+    return toRanges(result);
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,637 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/MappedIPAddressRangeTable.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include "ofLog.h"
+#include "ofUtils.h"
+
+
+#if defined(TARGET_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace ofx {
+namespace Net {
+
+
+static_assert(sizeof(MappedIPAddressRangeTable::Entry) == 24, "Unexpected Entry layout.");
+static_assert(sizeof(MappedIPAddressRangeTable::Header) == 88, "Unexpected Header layout.");
+static_assert(sizeof(IPAddressBits) == 16, "Unexpected IPAddressBits layout.");
+
+
+namespace {
+
+
+const char MAGIC[8] = { 'O', 'F', 'X', 'N', 'P', 'T', 'B', '\0' };
+
+
+const std::size_t SECTION_ALIGNMENT = 64;
+
+
+/// \brief The start of an interval and the entry that covers it.
+struct Point
+{
+    IPAddressBits start;
+    uint32_t index;
+};
+
+
+/// \brief The end of a range that contains the current position.
+struct OpenRange
+{
+    IPAddressBits last;
+    uint32_t index;
+};
+
+
+/// \brief A range waiting to be written and its position in the input.
+struct Item
+{
+    CompactIPAddressRange range;
+    IPAddressBits subnet;
+    uint32_t value;
+    std::size_t order;
+};
+
+
+uint64_t align(uint64_t offset)
+{
+    return (offset + SECTION_ALIGNMENT - 1) & ~uint64_t(SECTION_ALIGNMENT - 1);
+}
+
+
+bool isBefore(const Item& a, const Item& b)
+{
+    if (a.range.family() != b.range.family())
+        return a.range.family() < b.range.family();
+
+    if (a.subnet != b.subnet)
+        return a.subnet < b.subnet;
+
+    if (a.range.prefix() != b.range.prefix())
+        return a.range.prefix() < b.range.prefix();
+
+    return a.order < b.order;
+}
+
+
+bool isSameKey(const Item& a, const Item& b)
+{
+    return a.range.family() == b.range.family()
+        && a.range.prefix() == b.range.prefix()
+        && a.subnet == b.subnet;
+}
+
+
+/// \brief Start a new interval, merging it with the previous one if possible.
+void addPoint(std::vector<Point>& points, const IPAddressBits& start, uint32_t index)
+{
+    if (!points.empty() && points.back().start == start)
+        points.pop_back();
+
+    if (points.empty() || points.back().index != index)
+        points.push_back({ start, index });
+}
+
+
+/// \brief Flatten the nested ranges of one family into intervals.
+///
+/// Ranges must be sorted by subnet and then by prefix, so that each range
+/// follows every range that contains it.
+std::vector<Point> flatten(const std::vector<MappedIPAddressRangeTable::Entry>& entries,
+                           CompactIPAddress::Family family)
+{
+    const IPAddressBits zero = { 0, 0 };
+    const IPAddressBits unit = IPAddressBits{ 0, 1 }.shiftLeft(128 - CompactIPAddress::maximumPrefix(family));
+
+    std::vector<Point> points;
+    points.push_back({ zero, MappedIPAddressRangeTable::NONE });
+
+    // The ranges that contain the current position, innermost last.
+    std::vector<OpenRange> open;
+
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        const CompactIPAddressRange& range = entries[i].range;
+
+        if (range.family() != family)
+            continue;
+
+        const IPAddressBits first = range.hostMin().bits();
+
+        while (!open.empty() && open.back().last < first)
+        {
+            const IPAddressBits next = open.back().last + unit;
+            open.pop_back();
+            addPoint(points, next, open.empty() ? MappedIPAddressRangeTable::NONE : open.back().index);
+        }
+
+        addPoint(points, first, static_cast<uint32_t>(i));
+        open.push_back({ range.hostMax().bits(), static_cast<uint32_t>(i) });
+    }
+
+    while (!open.empty())
+    {
+        const IPAddressBits next = open.back().last + unit;
+        open.pop_back();
+
+        // A range that ends at the last address has no successor.
+        if (!next.isZero())
+            addPoint(points, next, open.empty() ? MappedIPAddressRangeTable::NONE : open.back().index);
+    }
+
+    return points;
+}
+
+
+void append(std::vector<char>& buffer, const void* data, std::size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+
+void appendPadding(std::vector<char>& buffer, uint64_t offset)
+{
+    buffer.resize(static_cast<std::size_t>(offset), 0);
+}
+
+
+/// \brief Replace a file atomically and durably.
+///
+/// The data is written to a uniquely named file in the same directory,
+/// flushed to disk and renamed over the destination, so concurrent writers
+/// do not share a temporary file and readers never see a partial table.
+bool replaceFile(const std::string& path, const std::vector<char>& data)
+{
+#if defined(TARGET_WIN32)
+    static std::atomic<unsigned> counter(0);
+
+    const std::string temporaryPath = path + "." + std::to_string(GetCurrentProcessId()) + "." + std::to_string(++counter) + ".tmp";
+
+    HANDLE file = CreateFileA(temporaryPath.c_str(),
+                              GENERIC_WRITE,
+                              0,
+                              nullptr,
+                              CREATE_NEW,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Unable to create file: " << temporaryPath;
+        return false;
+    }
+
+    std::size_t written = 0;
+    bool success = true;
+
+    while (success && written < data.size())
+    {
+        DWORD chunk = 0;
+        const DWORD size = static_cast<DWORD>(std::min<std::size_t>(data.size() - written, 1 << 30));
+        success = WriteFile(file, data.data() + written, size, &chunk, nullptr) != 0;
+        written += chunk;
+    }
+
+    success = success && FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+
+    if (!success)
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Unable to write file: " << temporaryPath;
+        DeleteFileA(temporaryPath.c_str());
+        return false;
+    }
+
+    if (!MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Unable to replace file: " << path;
+        DeleteFileA(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+#else
+    std::vector<char> temporaryPath(path.begin(), path.end());
+    const char suffix[] = ".XXXXXX";
+    temporaryPath.insert(temporaryPath.end(), suffix, suffix + sizeof(suffix));
+
+    int file = ::mkstemp(temporaryPath.data());
+
+    if (file < 0)
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Unable to create file: " << temporaryPath.data();
+        return false;
+    }
+
+    // mkstemp() creates the file readable by the owner only.
+    bool success = ::fchmod(file, 0644) == 0;
+    std::size_t written = 0;
+
+    while (success && written < data.size())
+    {
+        const ssize_t chunk = ::write(file, data.data() + written, data.size() - written);
+
+        if (chunk < 0 && errno == EINTR)
+            continue;
+
+        success = chunk > 0;
+        written += success ? static_cast<std::size_t>(chunk) : 0;
+    }
+
+    success = success && ::fsync(file) == 0;
+    success = ::close(file) == 0 && success;
+
+    if (!success)
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Unable to write file: " << temporaryPath.data();
+        ::unlink(temporaryPath.data());
+        return false;
+    }
+
+    if (::rename(temporaryPath.data(), path.c_str()) != 0)
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Unable to replace file: " << path;
+        ::unlink(temporaryPath.data());
+        return false;
+    }
+
+    // Make the rename itself durable.
+    const std::size_t slash = path.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    const int directoryFile = ::open(directory.c_str(), O_RDONLY);
+
+    if (directoryFile >= 0)
+    {
+        ::fsync(directoryFile);
+        ::close(directoryFile);
+    }
+
+    return true;
+#endif
+}
+
+
+bool fits(uint64_t offset, uint64_t count, std::size_t size, std::size_t length)
+{
+    return offset <= length
+        && offset % sizeof(uint64_t) == 0
+        && count <= (length - offset) / size;
+}
+
+
+} // namespace
+
+
+MappedIPAddressRangeTable::MappedIPAddressRangeTable():
+    _data(nullptr),
+    _length(0),
+    _entries(nullptr),
+    _entryCount(0),
+    _ipv4Starts(nullptr),
+    _ipv4Indices(nullptr),
+    _ipv4Count(0),
+    _ipv6Starts(nullptr),
+    _ipv6Indices(nullptr),
+    _ipv6Count(0)
+{
+}
+
+
+MappedIPAddressRangeTable::~MappedIPAddressRangeTable()
+{
+    close();
+}
+
+
+bool MappedIPAddressRangeTable::open(const std::string& path)
+{
+    close();
+
+    const std::string fullPath = ofToDataPath(path, true);
+
+#if defined(TARGET_WIN32)
+    HANDLE file = CreateFileA(fullPath.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        ofLogError("MappedIPAddressRangeTable::open") << "Unable to open file: " << fullPath;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < LONGLONG(sizeof(Header)))
+    {
+        CloseHandle(file);
+        ofLogError("MappedIPAddressRangeTable::open") << "Invalid file size: " << fullPath;
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (mapping == nullptr)
+    {
+        ofLogError("MappedIPAddressRangeTable::open") << "Unable to map file: " << fullPath;
+        return false;
+    }
+
+    // The view keeps the mapping alive after its handle is closed.
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (data == nullptr)
+    {
+        ofLogError("MappedIPAddressRangeTable::open") << "Unable to map file: " << fullPath;
+        return false;
+    }
+
+    _length = static_cast<std::size_t>(size.QuadPart);
+#else
+    int file = ::open(fullPath.c_str(), O_RDONLY);
+
+    if (file < 0)
+    {
+        ofLogError("MappedIPAddressRangeTable::open") << "Unable to open file: " << fullPath;
+        return false;
+    }
+
+    struct stat status;
+
+    if (fstat(file, &status) != 0 || status.st_size < off_t(sizeof(Header)))
+    {
+        ::close(file);
+        ofLogError("MappedIPAddressRangeTable::open") << "Invalid file size: " << fullPath;
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+
+    if (data == MAP_FAILED)
+    {
+        ofLogError("MappedIPAddressRangeTable::open") << "Unable to map file: " << fullPath;
+        return false;
+    }
+
+    _length = static_cast<std::size_t>(status.st_size);
+#endif
+
+    _data = static_cast<const uint8_t*>(data);
+
+    if (!load())
+    {
+        ofLogError("MappedIPAddressRangeTable::open") << "Invalid or incompatible table file: " << fullPath;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void MappedIPAddressRangeTable::close()
+{
+    if (_data)
+    {
+#if defined(TARGET_WIN32)
+        UnmapViewOfFile(_data);
+#else
+        munmap(const_cast<uint8_t*>(_data), _length);
+#endif
+    }
+
+    _data = nullptr;
+    _length = 0;
+    _entries = nullptr;
+    _entryCount = 0;
+    _ipv4Starts = nullptr;
+    _ipv4Indices = nullptr;
+    _ipv4Count = 0;
+    _ipv6Starts = nullptr;
+    _ipv6Indices = nullptr;
+    _ipv6Count = 0;
+}
+
+
+bool MappedIPAddressRangeTable::isOpen() const
+{
+    return _data != nullptr;
+}
+
+
+const MappedIPAddressRangeTable::Entry* MappedIPAddressRangeTable::find(const CompactIPAddress& address) const
+{
+    std::size_t position = 0;
+    uint32_t index = NONE;
+
+    if (address.isIPv4())
+    {
+        const uint32_t value = static_cast<uint32_t>(address.bits().high >> 32);
+        position = static_cast<std::size_t>(std::upper_bound(_ipv4Starts, _ipv4Starts + _ipv4Count, value) - _ipv4Starts);
+
+        if (position > 0)
+            index = _ipv4Indices[position - 1];
+    }
+    else
+    {
+        const IPAddressBits value = address.bits();
+        position = static_cast<std::size_t>(std::upper_bound(_ipv6Starts, _ipv6Starts + _ipv6Count, value) - _ipv6Starts);
+
+        if (position > 0)
+            index = _ipv6Indices[position - 1];
+    }
+
+    return index < _entryCount ? &_entries[index] : nullptr;
+}
+
+
+const MappedIPAddressRangeTable::Entry* MappedIPAddressRangeTable::find(const Poco::Net::IPAddress& address) const
+{
+    return find(CompactIPAddress(address));
+}
+
+
+const MappedIPAddressRangeTable::Entry* MappedIPAddressRangeTable::entries() const
+{
+    return _entries;
+}
+
+
+std::size_t MappedIPAddressRangeTable::size() const
+{
+    return _entryCount;
+}
+
+
+bool MappedIPAddressRangeTable::empty() const
+{
+    return _entryCount == 0;
+}
+
+
+bool MappedIPAddressRangeTable::write(const std::string& path,
+                                      const IPAddressRange::List& ranges)
+{
+    std::vector<uint32_t> values(ranges.size());
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<uint32_t>(i);
+
+    return write(path, ranges, values);
+}
+
+
+bool MappedIPAddressRangeTable::write(const std::string& path,
+                                      const IPAddressRange::List& ranges,
+                                      const std::vector<uint32_t>& values)
+{
+    if (ranges.size() != values.size())
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Range and value counts differ: " << ranges.size() << " != " << values.size();
+        return false;
+    }
+
+    if (ranges.size() >= NONE)
+    {
+        ofLogError("MappedIPAddressRangeTable::write") << "Too many ranges: " << ranges.size();
+        return false;
+    }
+
+    std::vector<Item> items;
+    items.reserve(ranges.size());
+
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        const CompactIPAddressRange& range = ranges[i].compact();
+        items.push_back({ range, range.subnet().bits(), values[i], i });
+    }
+
+    std::sort(items.begin(), items.end(), isBefore);
+
+    std::vector<Entry> entries;
+    entries.reserve(items.size());
+
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        // Keep the last of each run of duplicates.
+        if (i + 1 < items.size() && isSameKey(items[i], items[i + 1]))
+            continue;
+
+        Entry entry = { items[i].range, 0, items[i].value };
+        entries.push_back(entry);
+    }
+
+    const std::vector<Point> pointsIPv4 = flatten(entries, CompactIPAddress::IPv4);
+    const std::vector<Point> pointsIPv6 = flatten(entries, CompactIPAddress::IPv6);
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.entryCount = entries.size();
+    header.entryOffset = align(sizeof(Header));
+    header.ipv4Count = pointsIPv4.size();
+    header.ipv4StartOffset = align(header.entryOffset + header.entryCount * sizeof(Entry));
+    header.ipv4IndexOffset = align(header.ipv4StartOffset + header.ipv4Count * sizeof(uint32_t));
+    header.ipv6Count = pointsIPv6.size();
+    header.ipv6StartOffset = align(header.ipv4IndexOffset + header.ipv4Count * sizeof(uint32_t));
+    header.ipv6IndexOffset = align(header.ipv6StartOffset + header.ipv6Count * sizeof(IPAddressBits));
+    header.fileSize = header.ipv6IndexOffset + header.ipv6Count * sizeof(uint32_t);
+
+    std::vector<uint32_t> startsIPv4;
+    std::vector<uint32_t> indicesIPv4;
+    std::vector<IPAddressBits> startsIPv6;
+    std::vector<uint32_t> indicesIPv6;
+
+    for (const auto& point: pointsIPv4)
+    {
+        startsIPv4.push_back(static_cast<uint32_t>(point.start.high >> 32));
+        indicesIPv4.push_back(point.index);
+    }
+
+    for (const auto& point: pointsIPv6)
+    {
+        startsIPv6.push_back(point.start);
+        indicesIPv6.push_back(point.index);
+    }
+
+    std::vector<char> data;
+    data.reserve(static_cast<std::size_t>(header.fileSize));
+
+    append(data, &header, sizeof(Header));
+
+    appendPadding(data, header.entryOffset);
+    append(data, entries.data(), entries.size() * sizeof(Entry));
+
+    appendPadding(data, header.ipv4StartOffset);
+    append(data, startsIPv4.data(), startsIPv4.size() * sizeof(uint32_t));
+
+    appendPadding(data, header.ipv4IndexOffset);
+    append(data, indicesIPv4.data(), indicesIPv4.size() * sizeof(uint32_t));
+
+    appendPadding(data, header.ipv6StartOffset);
+    append(data, startsIPv6.data(), startsIPv6.size() * sizeof(IPAddressBits));
+
+    appendPadding(data, header.ipv6IndexOffset);
+    append(data, indicesIPv6.data(), indicesIPv6.size() * sizeof(uint32_t));
+
+    return replaceFile(ofToDataPath(path, true), data);
+}
+
+
+bool MappedIPAddressRangeTable::load()
+{
+    const Header* header = reinterpret_cast<const Header*>(_data);
+
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+     || header->version != VERSION
+     || header->byteOrder != BYTE_ORDER_MARK
+     || header->fileSize != _length
+     || !fits(header->entryOffset, header->entryCount, sizeof(Entry), _length)
+     || !fits(header->ipv4StartOffset, header->ipv4Count, sizeof(uint32_t), _length)
+     || !fits(header->ipv4IndexOffset, header->ipv4Count, sizeof(uint32_t), _length)
+     || !fits(header->ipv6StartOffset, header->ipv6Count, sizeof(IPAddressBits), _length)
+     || !fits(header->ipv6IndexOffset, header->ipv6Count, sizeof(uint32_t), _length))
+    {
+        return false;
+    }
+
+    _entries = reinterpret_cast<const Entry*>(_data + header->entryOffset);
+    _entryCount = static_cast<std::size_t>(header->entryCount);
+    _ipv4Starts = reinterpret_cast<const uint32_t*>(_data + header->ipv4StartOffset);
+    _ipv4Indices = reinterpret_cast<const uint32_t*>(_data + header->ipv4IndexOffset);
+    _ipv4Count = static_cast<std::size_t>(header->ipv4Count);
+    _ipv6Starts = reinterpret_cast<const IPAddressBits*>(_data + header->ipv6StartOffset);
+    _ipv6Indices = reinterpret_cast<const uint32_t*>(_data + header->ipv6IndexOffset);
+    _ipv6Count = static_cast<std::size_t>(header->ipv6Count);
+
+    return true;
+}
+
+
+} } // namespace ofx::Net
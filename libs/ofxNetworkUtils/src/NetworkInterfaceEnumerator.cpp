@@ -0,0 +1,414 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/NetworkInterfaceEnumerator.h"
+#include <algorithm>
+#include "Poco/Exception.h"
+#include "ofConstants.h"
+#include "ofLog.h"
+
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#define OFX_NET_NETLINK
+#include <cerrno>
+#include <cstring>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+
+namespace ofx {
+namespace Net {
+
+
+namespace {
+
+
+#if defined(OFX_NET_NETLINK)
+
+
+/// \brief Find an interface in a list sorted by index.
+NetworkInterfaceInfo* findIndex(NetworkInterfaceInfo::List& interfaces, unsigned index)
+{
+    auto iter = std::lower_bound(interfaces.begin(), interfaces.end(), index, [](const NetworkInterfaceInfo& info, unsigned value) {
+        return info.index < value;
+    });
+
+    return (iter != interfaces.end() && iter->index == index) ? &*iter : nullptr;
+}
+
+
+/// \brief Create an address from a netlink attribute.
+Poco::Net::IPAddress toAddress(const struct rtattr* attribute, unsigned scope)
+{
+    const std::size_t length = RTA_PAYLOAD(attribute);
+    return Poco::Net::IPAddress(RTA_DATA(attribute), static_cast<poco_socklen_t>(length), scope);
+}
+
+
+#endif
+
+
+} // namespace
+
+
+NetworkInterfaceEnumerator::NetworkInterfaceEnumerator(Backend backend):
+    _backend(backend),
+    _lastBackend(AUTOMATIC),
+    _socket(-1),
+    _sequence(0)
+{
+    if (_backend == AUTOMATIC)
+    {
+        _backend = isAvailable(NETLINK) ? NETLINK : POCO;
+    }
+    else if (!isAvailable(_backend))
+    {
+        ofLogWarning("NetworkInterfaceEnumerator") << "Netlink is not available, using Poco.";
+        _backend = POCO;
+    }
+}
+
+
+NetworkInterfaceEnumerator::~NetworkInterfaceEnumerator()
+{
+#if defined(OFX_NET_NETLINK)
+    if (_socket >= 0)
+        ::close(_socket);
+#endif
+}
+
+
+bool NetworkInterfaceEnumerator::enumerate(NetworkInterfaceInfo::List& interfaces)
+{
+    if (_backend == NETLINK && enumerateNetlink(interfaces))
+    {
+        _lastBackend = NETLINK;
+        return true;
+    }
+
+    _lastBackend = POCO;
+    return enumeratePoco(interfaces);
+}
+
+
+NetworkInterfaceEnumerator::Backend NetworkInterfaceEnumerator::backend() const
+{
+    return _backend;
+}
+
+
+NetworkInterfaceEnumerator::Backend NetworkInterfaceEnumerator::lastBackend() const
+{
+    return _lastBackend;
+}
+
+
+bool NetworkInterfaceEnumerator::isAvailable(Backend backend)
+{
+    if (backend != NETLINK)
+        return true;
+
+#if defined(OFX_NET_NETLINK)
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+NetworkInterfaceInfo NetworkInterfaceEnumerator::fromPoco(const Poco::Net::NetworkInterface& networkInterface)
+{
+    NetworkInterfaceInfo info;
+    info.index = networkInterface.index();
+    info.name = networkInterface.name();
+    info.macAddress = networkInterface.macAddress();
+    info.mtu = networkInterface.mtu();
+    info.isUp = networkInterface.isUp();
+    info.isRunning = networkInterface.isRunning();
+    info.isLoopback = networkInterface.isLoopback();
+    info.isPointToPoint = networkInterface.isPointToPoint();
+    info.supportsBroadcast = networkInterface.supportsBroadcast();
+    info.supportsMulticast = networkInterface.supportsMulticast();
+
+    for (const auto& tuple: networkInterface.addressList())
+    {
+        NetworkInterfaceInfo::AddressInfo address;
+        address.address = tuple.get<Poco::Net::NetworkInterface::IP_ADDRESS>();
+        address.subnetMask = tuple.get<Poco::Net::NetworkInterface::SUBNET_MASK>();
+        address.broadcastAddress = tuple.get<Poco::Net::NetworkInterface::BROADCAST_ADDRESS>();
+        info.addresses.push_back(address);
+    }
+
+    return info;
+}
+
+
+bool NetworkInterfaceEnumerator::enumeratePoco(NetworkInterfaceInfo::List& interfaces)
+{
+    interfaces.clear();
+
+    try
+    {
+        for (const auto& entry: Poco::Net::NetworkInterface::map())
+            interfaces.push_back(fromPoco(entry.second));
+
+        return true;
+    }
+    catch (const Poco::Exception& exc)
+    {
+        ofLogError("NetworkInterfaceEnumerator::enumerate") << exc.displayText();
+        return false;
+    }
+}
+
+
+#if defined(OFX_NET_NETLINK)
+
+
+bool NetworkInterfaceEnumerator::enumerateNetlink(NetworkInterfaceInfo::List& interfaces)
+{
+    if (_socket < 0)
+    {
+        _socket = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+
+        if (_socket < 0)
+        {
+            ofLogWarning("NetworkInterfaceEnumerator::enumerate") << "Unable to open a netlink socket: " << std::strerror(errno);
+            return false;
+        }
+
+        // Large enough for a full dump chunk from any current kernel.
+        _buffer.resize(64 * 1024);
+    }
+
+    interfaces.clear();
+
+    bool success = dump(RTM_GETLINK, [&interfaces](const struct nlmsghdr* message) {
+        if (message->nlmsg_type != RTM_NEWLINK)
+            return;
+
+        const struct ifinfomsg* link = static_cast<const struct ifinfomsg*>(NLMSG_DATA(message));
+
+        NetworkInterfaceInfo info;
+        info.index = static_cast<unsigned>(link->ifi_index);
+        info.isUp = (link->ifi_flags & IFF_UP) != 0;
+        info.isRunning = (link->ifi_flags & IFF_RUNNING) != 0;
+        info.isLoopback = (link->ifi_flags & IFF_LOOPBACK) != 0;
+        info.isPointToPoint = (link->ifi_flags & IFF_POINTOPOINT) != 0;
+        info.supportsBroadcast = (link->ifi_flags & IFF_BROADCAST) != 0;
+        info.supportsMulticast = (link->ifi_flags & IFF_MULTICAST) != 0;
+
+        const struct rtattr* attribute = IFLA_RTA(link);
+        int length = static_cast<int>(IFLA_PAYLOAD(message));
+
+        for (; RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length))
+        {
+            const unsigned char* data = static_cast<const unsigned char*>(RTA_DATA(attribute));
+
+            switch (attribute->rta_type)
+            {
+                case IFLA_IFNAME:
+                    info.name.assign(reinterpret_cast<const char*>(data), strnlen(reinterpret_cast<const char*>(data), RTA_PAYLOAD(attribute)));
+                    break;
+                case IFLA_ADDRESS:
+                    info.macAddress.assign(data, data + RTA_PAYLOAD(attribute));
+                    break;
+                case IFLA_MTU:
+                    if (RTA_PAYLOAD(attribute) >= sizeof(uint32_t))
+                    {
+                        uint32_t mtu = 0;
+                        std::memcpy(&mtu, data, sizeof(mtu));
+                        info.mtu = mtu;
+                    }
+                    break;
+            }
+        }
+
+        interfaces.push_back(std::move(info));
+    });
+
+    if (!success)
+        return false;
+
+    std::sort(interfaces.begin(), interfaces.end(), [](const NetworkInterfaceInfo& a, const NetworkInterfaceInfo& b) {
+        return a.index < b.index;
+    });
+
+    success = dump(RTM_GETADDR, [&interfaces](const struct nlmsghdr* message) {
+        if (message->nlmsg_type != RTM_NEWADDR)
+            return;
+
+        const struct ifaddrmsg* header = static_cast<const struct ifaddrmsg*>(NLMSG_DATA(message));
+
+        if (header->ifa_family != AF_INET && header->ifa_family != AF_INET6)
+            return;
+
+        NetworkInterfaceInfo* info = findIndex(interfaces, header->ifa_index);
+
+        if (!info)
+            return;
+
+        const struct rtattr* address = nullptr;
+        const struct rtattr* local = nullptr;
+        const struct rtattr* broadcast = nullptr;
+
+        const struct rtattr* attribute = IFA_RTA(header);
+        int length = static_cast<int>(IFA_PAYLOAD(message));
+
+        for (; RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length))
+        {
+            switch (attribute->rta_type)
+            {
+                case IFA_ADDRESS:
+                    address = attribute;
+                    break;
+                case IFA_LOCAL:
+                    local = attribute;
+                    break;
+                case IFA_BROADCAST:
+                    broadcast = attribute;
+                    break;
+            }
+        }
+
+        // IFA_LOCAL is the interface's own address. When both are present,
+        // IFA_ADDRESS is the peer of a point-to-point link.
+        const struct rtattr* own = local ? local : address;
+
+        if (!own)
+            return;
+
+        const Poco::Net::IPAddress::Family family = header->ifa_family == AF_INET
+                                                  ? Poco::Net::IPAddress::IPv4
+                                                  : Poco::Net::IPAddress::IPv6;
+
+        NetworkInterfaceInfo::AddressInfo entry;
+        entry.address = toAddress(own, 0);
+
+        // Match the system resolver, which scopes link-local IPv6 addresses.
+        if (family == Poco::Net::IPAddress::IPv6 && entry.address.isLinkLocal())
+            entry.address = toAddress(own, header->ifa_index);
+
+        entry.subnetMask = Poco::Net::IPAddress(header->ifa_prefixlen, family);
+        entry.broadcastAddress = Poco::Net::IPAddress(family);
+
+        if (broadcast)
+            entry.broadcastAddress = toAddress(broadcast, 0);
+        else if (local && address && info->isPointToPoint)
+            entry.broadcastAddress = toAddress(address, 0);
+
+        info->addresses.push_back(entry);
+    });
+
+    if (!success)
+        return false;
+
+    // NetworkInterface::map() lists only interfaces that are up and have an
+    // address.
+    interfaces.erase(std::remove_if(interfaces.begin(), interfaces.end(), [](const NetworkInterfaceInfo& info) {
+        return !info.isUp || info.addresses.empty();
+    }), interfaces.end());
+
+    return true;
+}
+
+
+template<typename Handler>
+bool NetworkInterfaceEnumerator::dump(uint16_t type, Handler handler)
+{
+    struct
+    {
+        struct nlmsghdr header;
+        struct ifinfomsg message;
+    } request;
+
+    std::memset(&request, 0, sizeof(request));
+    request.header.nlmsg_len = NLMSG_LENGTH(type == RTM_GETLINK ? sizeof(struct ifinfomsg) : sizeof(struct ifaddrmsg));
+    request.header.nlmsg_type = type;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = ++_sequence;
+
+    struct sockaddr_nl kernel;
+    std::memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    if (::sendto(_socket, &request, request.header.nlmsg_len, 0, reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel)) < 0)
+    {
+        ofLogError("NetworkInterfaceEnumerator::enumerate") << "Netlink request failed: " << std::strerror(errno);
+        return false;
+    }
+
+    while (true)
+    {
+        const ssize_t size = ::recv(_socket, _buffer.data(), _buffer.size(), MSG_TRUNC);
+
+        if (size < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ofLogError("NetworkInterfaceEnumerator::enumerate") << "Netlink receive failed: " << std::strerror(errno);
+            return false;
+        }
+
+        if (static_cast<std::size_t>(size) > _buffer.size())
+        {
+            // Grow for the next attempt. The rest of this dump is skipped by
+            // its sequence number.
+            _buffer.resize(static_cast<std::size_t>(size));
+            ofLogError("NetworkInterfaceEnumerator::enumerate") << "Netlink reply truncated.";
+            return false;
+        }
+
+        const struct nlmsghdr* message = reinterpret_cast<const struct nlmsghdr*>(_buffer.data());
+        int remaining = static_cast<int>(size);
+
+        for (; NLMSG_OK(message, remaining); message = NLMSG_NEXT(message, remaining))
+        {
+            // Skip anything left over from an earlier, abandoned dump.
+            if (message->nlmsg_seq != _sequence)
+                continue;
+
+            if (message->nlmsg_flags & NLM_F_DUMP_INTR)
+            {
+                // The tables changed during the dump, so the result may be
+                // inconsistent. The caller falls back to Poco.
+                return false;
+            }
+
+            if (message->nlmsg_type == NLMSG_DONE)
+                return true;
+
+            if (message->nlmsg_type == NLMSG_ERROR)
+            {
+                ofLogError("NetworkInterfaceEnumerator::enumerate") << "Netlink dump failed.";
+                return false;
+            }
+
+            handler(message);
+        }
+    }
+}
+
+
+#else
+
+
+bool NetworkInterfaceEnumerator::enumerateNetlink(NetworkInterfaceInfo::List&)
+{
+    return false;
+}
+
+
+#endif
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,220 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/NetworkInterfaceFilter.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+NetworkInterfaceFilter::Candidate::Candidate(const NetworkInterfaceEvent& event):
+    event(event),
+    families(0)
+{
+    if (event.type == NetworkInterfaceEvent::ADDRESS_ADDED
+     || event.type == NetworkInterfaceEvent::ADDRESS_REMOVED)
+    {
+        addresses.push_back(CompactIPAddress(event.address.address));
+    }
+    else
+    {
+        for (const auto& entry: event.info.addresses)
+            addresses.push_back(CompactIPAddress(entry.address));
+    }
+
+    for (const auto& address: addresses)
+        families |= address.isIPv4() ? NetworkInterfaceQuery::IPV4 : NetworkInterfaceQuery::IPV6;
+}
+
+
+NetworkInterfaceFilter::NetworkInterfaceFilter():
+    _eventTypes(ALL_EVENT_TYPES),
+    _nameMatch(ANY_NAME),
+    _hasIndex(false),
+    _index(0),
+    _families(NetworkInterfaceQuery::ANY_FAMILY)
+{
+}
+
+
+NetworkInterfaceFilter& NetworkInterfaceFilter::setEventTypes(uint32_t eventTypes)
+{
+    _eventTypes = eventTypes;
+    return *this;
+}
+
+
+NetworkInterfaceFilter& NetworkInterfaceFilter::setName(const std::string& pattern)
+{
+    const std::size_t wildcard = pattern.find_first_of("*?");
+
+    if (pattern.empty() || pattern == "*")
+    {
+        _nameMatch = ANY_NAME;
+        _name.clear();
+    }
+    else if (wildcard == std::string::npos)
+    {
+        _nameMatch = EXACT_NAME;
+        _name = pattern;
+    }
+    else if (wildcard == pattern.size() - 1 && pattern[wildcard] == '*')
+    {
+        _nameMatch = PREFIX_NAME;
+        _name = pattern.substr(0, wildcard);
+    }
+    else
+    {
+        _nameMatch = GLOB_NAME;
+        _name = pattern;
+    }
+
+    return *this;
+}
+
+
+NetworkInterfaceFilter& NetworkInterfaceFilter::setIndex(unsigned index)
+{
+    _hasIndex = true;
+    _index = index;
+    return *this;
+}
+
+
+NetworkInterfaceFilter& NetworkInterfaceFilter::clearIndex()
+{
+    _hasIndex = false;
+    return *this;
+}
+
+
+NetworkInterfaceFilter& NetworkInterfaceFilter::setFamilies(uint32_t families)
+{
+    _families = families;
+    return *this;
+}
+
+
+NetworkInterfaceFilter& NetworkInterfaceFilter::addRange(const IPAddressRange& range)
+{
+    _ranges.push_back(range.compact());
+    return *this;
+}
+
+
+NetworkInterfaceFilter& NetworkInterfaceFilter::clearRanges()
+{
+    _ranges.clear();
+    return *this;
+}
+
+
+bool NetworkInterfaceFilter::matches(const Candidate& candidate) const
+{
+    const NetworkInterfaceEvent& event = candidate.event;
+
+    // Cheapest tests first.
+    if ((_eventTypes & eventTypeFlag(event.type)) == 0)
+        return false;
+
+    if (_hasIndex && event.info.index != _index)
+        return false;
+
+    switch (_nameMatch)
+    {
+        case ANY_NAME:
+            break;
+        case EXACT_NAME:
+            if (event.info.name != _name)
+                return false;
+            break;
+        case PREFIX_NAME:
+            if (event.info.name.compare(0, _name.size(), _name) != 0)
+                return false;
+            break;
+        case GLOB_NAME:
+            if (!glob(_name, event.info.name))
+                return false;
+            break;
+    }
+
+    if (_families != NetworkInterfaceQuery::ANY_FAMILY && (candidate.families & _families) == 0)
+        return false;
+
+    if (_ranges.empty())
+        return true;
+
+    for (const auto& address: candidate.addresses)
+    {
+        const uint32_t family = address.isIPv4() ? NetworkInterfaceQuery::IPV4 : NetworkInterfaceQuery::IPV6;
+
+        if ((family & _families) == 0)
+            continue;
+
+        for (const auto& range: _ranges)
+        {
+            if (range.contains(address))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool NetworkInterfaceFilter::matches(const NetworkInterfaceEvent& event) const
+{
+    return matches(Candidate(event));
+}
+
+
+uint32_t NetworkInterfaceFilter::eventTypeFlag(NetworkInterfaceEvent::Type type)
+{
+    return 1u << static_cast<unsigned>(type);
+}
+
+
+bool NetworkInterfaceFilter::glob(const std::string& pattern, const std::string& name)
+{
+    // Iterative matching that backtracks to the most recent *.
+    std::size_t p = 0;
+    std::size_t n = 0;
+    std::size_t star = std::string::npos;
+    std::size_t resume = 0;
+
+    while (n < name.size())
+    {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+        {
+            ++p;
+            ++n;
+        }
+        else if (p < pattern.size() && pattern[p] == '*')
+        {
+            star = p++;
+            resume = n;
+        }
+        else if (star != std::string::npos)
+        {
+            p = star + 1;
+            n = ++resume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*')
+        ++p;
+
+    return p == pattern.size();
+}
+
+
+} } // namespace ofx::Net
@@ -6,81 +6,855 @@
 
 
 #include "ofx/Net/NetworkInterfaceListener.h"
+#include <algorithm>
+#include <limits>
 #include "Poco/Net/NetException.h"
+#include "ofConstants.h"
+#include "ofLog.h"
 #include "ofUtils.h"
 
 
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#elif !defined(TARGET_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
 namespace ofx {
 namespace Net {
 
 
-NetworkInterfaceListener::NetworkInterfaceListener():
-    _updateListener(ofEvents().update.newListener(this, &NetworkInterfaceListener::update))
+NetworkInterfaceListener::NetworkInterfaceListener(Backend backend,
+                                                   Threading threading):
+    NetworkInterfaceListener(NetworkInterfaceSource::system(), backend, threading)
 {
 }
 
 
+NetworkInterfaceListener::NetworkInterfaceListener(std::shared_ptr<NetworkInterfaceSource> source,
+                                                   Backend backend,
+                                                   Threading threading):
+    _source(source),
+    _backend(backend),
+    _threading(threading),
+    _updateInterval(DEFAULT_POLL_INTERVAL),
+    _rawEvents(0),
+    _deliveredEvents(0),
+    _suppressions(0)
+{
+    if (_threading != MANUAL)
+        _updateListener = ofEvents().update.newListener(this, &NetworkInterfaceListener::update);
+
+    if (_backend != POLLING && !_source->isWatching())
+    {
+        if (_backend == NOTIFICATION)
+            ofLogWarning("NetworkInterfaceListener") << "Change notifications are not available, polling instead.";
+
+        _backend = POLLING;
+    }
+    else if (_backend == AUTOMATIC)
+    {
+        _backend = NOTIFICATION;
+    }
+
+    if (_threading == BACKGROUND_THREAD)
+    {
+        if (_backend == NOTIFICATION)
+        {
+            _callbackId = _source->addChangeCallback([this]() {
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _changed = true;
+                }
+
+                _condition.notify_one();
+            });
+        }
+    }
+    else if (_threading == MANUAL)
+    {
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+        // One epoll descriptor reports both change notifications, through
+        // the eventfd, and poll or damping deadlines, through the timerfd.
+        _signalFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        _drainFd = _signalFd;
+        _timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        _fd = ::epoll_create1(EPOLL_CLOEXEC);
+
+        if (_signalFd < 0 || _timerFd < 0 || _fd < 0)
+        {
+            ofLogError("NetworkInterfaceListener::NetworkInterfaceListener") << "Unable to create the event descriptors.";
+        }
+        else
+        {
+            for (int descriptor: { _signalFd, _timerFd })
+            {
+                epoll_event event = {};
+                event.events = EPOLLIN;
+                event.data.fd = descriptor;
+                ::epoll_ctl(_fd, EPOLL_CTL_ADD, descriptor, &event);
+            }
+        }
+#elif !defined(TARGET_WIN32)
+        int pipeFds[2];
+
+        if (::pipe(pipeFds) == 0)
+        {
+            for (int descriptor: pipeFds)
+            {
+                ::fcntl(descriptor, F_SETFL, ::fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+                ::fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+            }
+
+            _drainFd = pipeFds[0];
+            _signalFd = pipeFds[1];
+            _fd = _drainFd;
+        }
+        else
+        {
+            ofLogError("NetworkInterfaceListener::NetworkInterfaceListener") << "Unable to create the event descriptors.";
+        }
+#endif
+
+        if (_backend == NOTIFICATION)
+            _callbackId = _source->addChangeCallback([this]() { signal(); });
+
+        // Readable at once, so the first process() reports the interfaces.
+        signal();
+    }
+}
+
+
 NetworkInterfaceListener::~NetworkInterfaceListener()
 {
+    if (_callbackId != 0)
+        _source->removeChangeCallback(_callbackId);
+
+    if (_thread.joinable())
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+
+        _condition.notify_one();
+        _thread.join();
+    }
+
+#if !defined(TARGET_WIN32)
+    // The eventfd is both _signalFd and _drainFd, and the read end of a pipe
+    // is both _drainFd and _fd.
+    if (_fd >= 0 && _fd != _drainFd)
+        ::close(_fd);
+
+    if (_drainFd >= 0)
+        ::close(_drainFd);
+
+    if (_signalFd >= 0 && _signalFd != _drainFd)
+        ::close(_signalFd);
+
+    if (_timerFd >= 0)
+        ::close(_timerFd);
+#endif
 }
 
 
 void NetworkInterfaceListener::update(ofEventArgs& args)
 {
-    auto now = ofGetElapsedTimeMillis();
+    if (_threading == MANUAL)
+    {
+        process();
+        return;
+    }
+
+    Batch batch;
+
+    if (_threading == BACKGROUND_THREAD)
+    {
+        // Started here so listeners added after construction, e.g. in
+        // setup(), see the initial events.
+        if (!_thread.joinable())
+            _thread = std::thread(&NetworkInterfaceListener::run, this);
+
+        while (_queue.pop(batch))
+            deliver(batch);
+
+        return;
+    }
+
+    std::shared_ptr<const NetworkInterfaceSnapshot> snapshot = _detected;
+
+    if (_backend == NOTIFICATION)
+    {
+        // Only rebuilt after the operating system reports a change.
+        snapshot = _source->current();
+    }
+    else
+    {
+        auto now = ofGetElapsedTimeMillis();
+
+        if (_lastUpdate == 0 || (now - _lastUpdate) >= _updateInterval)
+        {
+            snapshot = _source->refresh();
+            _lastUpdate = now;
+        }
+    }
+
+    if (snapshot && detect(snapshot, batch))
+        deliver(batch);
+}
+
+
+void NetworkInterfaceListener::process()
+{
+    if (_threading != MANUAL)
+        return;
+
+    // Drained before reading the snapshot so a change during detection
+    // leaves fd() readable.
+    drain();
+
+    std::shared_ptr<const NetworkInterfaceSnapshot> snapshot = _detected;
 
-    if (_lastUpdate == 0 || (now + _lastUpdate) > _updateInterval)
+    if (_backend == NOTIFICATION)
+    {
+        snapshot = _source->current();
+    }
+    else
     {
-        auto interfaces = Poco::Net::NetworkInterface::map();
+        const Clock::time_point now = Clock::now();
 
+        if (now >= _nextPoll)
         {
-            auto _iter = _interfaces.cbegin();
+            snapshot = _source->refresh();
+            _nextPoll = now + std::chrono::milliseconds(_updateInterval.load());
+        }
+    }
+
+    Batch batch;
+
+    if (snapshot && detect(snapshot, batch))
+        deliver(batch);
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+    if (_timerFd >= 0)
+    {
+        itimerspec spec = {};
+        const Clock::time_point wake = nextWake();
+
+        if (wake != Clock::time_point::max())
+        {
+            // steady_clock is CLOCK_MONOTONIC. A zero value would disarm.
+            const auto nanoseconds = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(wake.time_since_epoch()).count());
+            spec.it_value.tv_sec = nanoseconds / 1000000000;
+            spec.it_value.tv_nsec = nanoseconds % 1000000000;
+        }
+
+        ::timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+#endif
+}
+
+
+int NetworkInterfaceListener::fd() const
+{
+    return _fd;
+}
+
+
+int NetworkInterfaceListener::timeout() const
+{
+    if (_threading != MANUAL)
+        return -1;
+
+    const Clock::time_point now = Clock::now();
+
+    Clock::time_point wake = nextWake();
+
+    // Without a descriptor, notifications are only seen by calling
+    // process(), so the wait is bounded by the update interval.
+    if (_fd < 0)
+        wake = std::min(wake, now + std::chrono::milliseconds(_updateInterval.load()));
+
+    if (wake == Clock::time_point::max())
+        return -1;
+
+    if (wake <= now)
+        return 0;
+
+    // Rounded up so a poll() that times out finds the deadline passed.
+    const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(wake - now).count();
+    return static_cast<int>(std::min<int64_t>((remaining + 999) / 1000, std::numeric_limits<int>::max()));
+}
+
+
+void NetworkInterfaceListener::signal()
+{
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+    const uint64_t one = 1;
+
+    if (_signalFd >= 0 && ::write(_signalFd, &one, sizeof(one)) < 0)
+    {
+        // EAGAIN means the counter is already nonzero.
+    }
+#elif !defined(TARGET_WIN32)
+    const char one = 1;
+
+    if (_signalFd >= 0 && ::write(_signalFd, &one, sizeof(one)) < 0)
+    {
+        // EAGAIN means the pipe is already readable.
+    }
+#endif
+}
+
+
+void NetworkInterfaceListener::drain()
+{
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+    uint64_t count = 0;
+
+    if (_drainFd >= 0 && ::read(_drainFd, &count, sizeof(count)) < 0)
+    {
+        // EAGAIN means there was no notification.
+    }
+
+    if (_timerFd >= 0 && ::read(_timerFd, &count, sizeof(count)) < 0)
+    {
+        // EAGAIN means the timer has not expired.
+    }
+#elif !defined(TARGET_WIN32)
+    char buffer[64];
+
+    while (_drainFd >= 0 && ::read(_drainFd, buffer, sizeof(buffer)) > 0)
+    {
+    }
+#endif
+}
+
+
+NetworkInterfaceListener::Clock::time_point NetworkInterfaceListener::nextWake() const
+{
+    return _backend == NOTIFICATION ? _nextDeadline : std::min(_nextPoll, _nextDeadline);
+}
 
-            while (_iter != _interfaces.cend())
+
+bool NetworkInterfaceListener::detect(std::shared_ptr<const NetworkInterfaceSnapshot> snapshot,
+                                      Batch& batch)
+{
+    const bool changed = snapshot != _detected;
+
+    if (!changed && _nextDeadline == Clock::time_point::max())
+        return false;
+
+    DampingSettings settings;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        settings = _dampingSettings;
+    }
+
+    const Clock::time_point now = Clock::now();
+
+    batch.snapshot = snapshot;
+    batch.events.clear();
+
+    std::vector<NetworkInterfaceEvent> events;
+
+    if (changed)
+    {
+        static const NetworkInterfaceInfo::List none;
+        static const std::vector<uint64_t> noFingerprints;
+
+        const auto& previous = _detected ? _detected->interfaces() : none;
+        const auto& previousFingerprints = _detected ? _detected->fingerprints() : noFingerprints;
+        const auto& current = snapshot->interfaces();
+        const auto& currentFingerprints = snapshot->fingerprints();
+
+        // Both lists are in index order, so one merge pass pairs them up.
+        std::size_t i = 0;
+        std::size_t j = 0;
+
+        while (i < previous.size() || j < current.size())
+        {
+            if (j == current.size() || (i < previous.size() && previous[i].index < current[j].index))
             {
-                if (interfaces.find(_iter->first) == interfaces.end())
-                {
-                    Poco::Net::NetworkInterface updated;
-
-                    try
-                    {
-                        updated = Poco::Net::NetworkInterface::forIndex(_iter->second.index());
-                    }
-                    catch (const Poco::Net::InterfaceNotFoundException& exc)
-                    {
-                        updated = Poco::Net::NetworkInterface(_iter->second.index());
-                    }
-
-                    onInterfaceDown.notify(this, updated);
-                }
+                transition(&previous[i], nullptr, events);
+                ++i;
+            }
+            else if (i == previous.size() || current[j].index < previous[i].index)
+            {
+                transition(nullptr, &current[j], events);
+                ++j;
+            }
+            else
+            {
+                if (previousFingerprints[i] != currentFingerprints[j])
+                    compare(previous[i], current[j], events);
 
-                ++_iter;
+                ++i;
+                ++j;
             }
         }
 
+        _detected = snapshot;
+        _rawEvents += events.size();
+
+        if (settings.quietWindow.count() > 0)
+        {
+            damp(events, settings, now);
+            events.clear();
+        }
+    }
+
+    // Once damping is off, changes still held are delivered before newer
+    // ones rather than after them.
+    flush(now, batch.events, settings.quietWindow.count() == 0);
+    batch.events.insert(batch.events.end(), events.begin(), events.end());
+
+    _deliveredEvents += batch.events.size();
+
+    for (const auto& event: batch.events)
+        onChangeImmediate.notify(this, event);
+
+    return changed || !batch.events.empty();
+}
+
+
+void NetworkInterfaceListener::transition(const NetworkInterfaceInfo* previous,
+                                          const NetworkInterfaceInfo* current,
+                                          std::vector<NetworkInterfaceEvent>& events)
+{
+    if (previous && current)
+    {
+        compare(*previous, *current, events);
+    }
+    else if (previous)
+    {
+        NetworkInterfaceEvent event;
+        event.type = NetworkInterfaceEvent::INTERFACE_DOWN;
+        event.info = *previous;
+        event.previousInfo = *previous;
+        event.interface = Poco::Net::NetworkInterface(previous->index);
+        events.push_back(event);
+    }
+    else if (current)
+    {
+        NetworkInterfaceEvent event;
+        event.type = NetworkInterfaceEvent::INTERFACE_UP;
+        event.info = *current;
+        event.interface = Poco::Net::NetworkInterface(current->index);
+        events.push_back(event);
+    }
+}
+
+
+Poco::Net::NetworkInterface NetworkInterfaceListener::pocoInterface(const NetworkInterfaceEvent& event,
+                                                                    const NetworkInterfaceSnapshot& snapshot)
+{
+    if (!snapshot.isSystem())
+        return event.interface;
+
+    if (event.type == NetworkInterfaceEvent::INTERFACE_UP)
+    {
+        const auto& map = snapshot.map();
+        auto iter = map.find(event.info.index);
+
+        if (iter != map.end())
+            return iter->second;
+    }
+    else
+    {
+        // An interface that only lost its addresses is still enumerable.
+        try
+        {
+            return Poco::Net::NetworkInterface::forIndex(event.info.index);
+        }
+        catch (const Poco::Net::InterfaceNotFoundException&)
+        {
+        }
+    }
+
+    return event.interface;
+}
+
+
+void NetworkInterfaceListener::compare(const NetworkInterfaceInfo& previous,
+                                       const NetworkInterfaceInfo& current,
+                                       std::vector<NetworkInterfaceEvent>& events)
+{
+    NetworkInterfaceEvent event;
+    event.info = current;
+    event.previousInfo = previous;
+
+    auto contains = [](const NetworkInterfaceInfo& info, const NetworkInterfaceInfo::AddressInfo& address) {
+        for (const auto& entry: info.addresses)
         {
-            auto iter = interfaces.cbegin();
+            if (entry.address == address.address
+             && entry.subnetMask == address.subnetMask
+             && entry.broadcastAddress == address.broadcastAddress)
+                return true;
+        }
+
+        return false;
+    };
 
-            while (iter != interfaces.cend())
+    for (const auto& address: previous.addresses)
+    {
+        if (!contains(current, address))
+        {
+            event.type = NetworkInterfaceEvent::ADDRESS_REMOVED;
+            event.address = address;
+            events.push_back(event);
+        }
+    }
+
+    for (const auto& address: current.addresses)
+    {
+        if (!contains(previous, address))
+        {
+            event.type = NetworkInterfaceEvent::ADDRESS_ADDED;
+            event.address = address;
+            events.push_back(event);
+        }
+    }
+
+    event.address = NetworkInterfaceInfo::AddressInfo();
+
+    if (previous.isUp != current.isUp
+     || previous.isRunning != current.isRunning
+     || previous.isLoopback != current.isLoopback
+     || previous.isPointToPoint != current.isPointToPoint
+     || previous.supportsBroadcast != current.supportsBroadcast
+     || previous.supportsMulticast != current.supportsMulticast)
+    {
+        event.type = NetworkInterfaceEvent::FLAGS_CHANGED;
+        events.push_back(event);
+    }
+
+    if (previous.mtu != current.mtu)
+    {
+        event.type = NetworkInterfaceEvent::MTU_CHANGED;
+        events.push_back(event);
+    }
+
+    if (previous.macAddress != current.macAddress)
+    {
+        event.type = NetworkInterfaceEvent::MAC_ADDRESS_CHANGED;
+        events.push_back(event);
+    }
+}
+
+
+void NetworkInterfaceListener::damp(const std::vector<NetworkInterfaceEvent>& events,
+                                    const DampingSettings& settings,
+                                    Clock::time_point now)
+{
+    // The events of one interface are adjacent and share the same states.
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        const NetworkInterfaceEvent& event = events[i];
+
+        if (i > 0 && events[i - 1].info.index == event.info.index)
+            continue;
+
+        DampingRecord& record = _damping[event.info.index];
+
+        if (!record.pending)
+        {
+            record.pending = true;
+            record.baselinePresent = event.type != NetworkInterfaceEvent::INTERFACE_UP;
+            record.baseline = event.previousInfo;
+            record.changes = 0;
+
+            if (record.window.count() == 0 || now - record.lastChange >= record.window * 2)
+                record.window = settings.quietWindow;
+        }
+
+        record.latestPresent = event.type != NetworkInterfaceEvent::INTERFACE_DOWN;
+        record.latest = event.info;
+        record.lastChange = now;
+
+        if (++record.changes >= settings.flapThreshold)
+        {
+            record.window = std::min(record.window * 2, settings.maximumWindow);
+            record.changes = 0;
+            ++_suppressions;
+        }
+
+        record.deadline = now + record.window;
+        _nextDeadline = std::min(_nextDeadline, record.deadline);
+    }
+}
+
+
+void NetworkInterfaceListener::flush(Clock::time_point now,
+                                     std::vector<NetworkInterfaceEvent>& events,
+                                     bool all)
+{
+    if (!all && now < _nextDeadline)
+        return;
+
+    _nextDeadline = Clock::time_point::max();
+
+    auto iter = _damping.begin();
+
+    while (iter != _damping.end())
+    {
+        DampingRecord& record = iter->second;
+
+        if (record.pending && (all || record.deadline <= now))
+        {
+            transition(record.baselinePresent ? &record.baseline : nullptr,
+                       record.latestPresent ? &record.latest : nullptr,
+                       events);
+
+            record.pending = false;
+        }
+
+        if (record.pending)
+        {
+            _nextDeadline = std::min(_nextDeadline, record.deadline);
+        }
+        else
+        {
+            // Kept only to remember the window of a flapping interface.
+            record.baseline = NetworkInterfaceInfo();
+            record.latest = NetworkInterfaceInfo();
+
+            if (now - record.lastChange >= record.window * 2)
             {
-                if (_interfaces.find(iter->first) == _interfaces.end())
+                iter = _damping.erase(iter);
+                continue;
+            }
+
+            _nextDeadline = std::min(_nextDeadline, record.lastChange + record.window * 2);
+        }
+
+        ++iter;
+    }
+}
+
+
+void NetworkInterfaceListener::deliver(const Batch& batch)
+{
+    std::shared_ptr<const Subscriptions> subscriptions;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        subscriptions = _subscriptions;
+    }
+
+    _snapshot = batch.snapshot;
+
+    std::vector<const Subscription*> matched;
+
+    for (const auto& event: batch.events)
+    {
+        switch (event.type)
+        {
+            case NetworkInterfaceEvent::INTERFACE_UP:
+                if (onInterfaceUp.size() > 0)
                 {
-                    onInterfaceUp.notify(this, iter->second);
+                    const Poco::Net::NetworkInterface networkInterface = pocoInterface(event, *batch.snapshot);
+                    onInterfaceUp.notify(this, networkInterface);
                 }
-                
-                ++iter;
+                break;
+            case NetworkInterfaceEvent::INTERFACE_DOWN:
+                if (onInterfaceDown.size() > 0)
+                {
+                    const Poco::Net::NetworkInterface networkInterface = pocoInterface(event, *batch.snapshot);
+                    onInterfaceDown.notify(this, networkInterface);
+                }
+                break;
+            case NetworkInterfaceEvent::ADDRESS_ADDED:
+                onAddressAdded.notify(this, event);
+                break;
+            case NetworkInterfaceEvent::ADDRESS_REMOVED:
+                onAddressRemoved.notify(this, event);
+                break;
+            case NetworkInterfaceEvent::FLAGS_CHANGED:
+                onFlagsChanged.notify(this, event);
+                break;
+            case NetworkInterfaceEvent::MTU_CHANGED:
+                onMTUChanged.notify(this, event);
+                break;
+            case NetworkInterfaceEvent::MAC_ADDRESS_CHANGED:
+                onMACAddressChanged.notify(this, event);
+                break;
+        }
+
+        onChange.notify(this, event);
+
+        if (subscriptions && !subscriptions->empty())
+        {
+            const NetworkInterfaceFilter::Candidate candidate(event);
+
+            // Every filter is tested before any handler runs.
+            matched.clear();
+
+            for (const auto& subscription: *subscriptions)
+            {
+                if (subscription.filter.matches(candidate))
+                    matched.push_back(&subscription);
             }
+
+            for (const auto* subscription: matched)
+                subscription->handler(event);
         }
-        
-        _interfaces = interfaces;
-        _lastUpdate = now;
+    }
+}
+
+
+void NetworkInterfaceListener::run()
+{
+    Clock::time_point nextPoll = Clock::now();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stopping)
+    {
+        // Cleared before reading so a change during detection is not lost.
+        _changed = false;
+
+        lock.unlock();
+
+        std::shared_ptr<const NetworkInterfaceSnapshot> snapshot = _detected;
+
+        if (_backend == NOTIFICATION)
+        {
+            snapshot = _source->current();
+        }
+        else if (Clock::now() >= nextPoll)
+        {
+            snapshot = _source->refresh();
+            nextPoll = Clock::now() + std::chrono::milliseconds(_updateInterval.load());
+        }
+
+        Batch batch;
+
+        if (snapshot && detect(snapshot, batch))
+        {
+            _queue.push(std::move(batch));
+        }
+
+        lock.lock();
+
+        // Wake for the next poll or for held changes that come due.
+        Clock::time_point wake = _backend == NOTIFICATION ? _nextDeadline : std::min(nextPoll, _nextDeadline);
+
+        auto ready = [this]() { return _changed || _stopping; };
+
+        if (wake == Clock::time_point::max())
+            _condition.wait(lock, ready);
+        else
+            _condition.wait_until(lock, wake, ready);
     }
 }
 
 
 const Poco::Net::NetworkInterface::Map& NetworkInterfaceListener::interfaces() const
 {
-    return _interfaces;
+    static const Poco::Net::NetworkInterface::Map empty;
+    return _snapshot ? _snapshot->map() : empty;
+}
+
+
+std::shared_ptr<NetworkInterfaceSource> NetworkInterfaceListener::source() const
+{
+    return _source;
+}
+
+
+NetworkInterfaceListener::Backend NetworkInterfaceListener::backend() const
+{
+    return _backend;
+}
+
+
+NetworkInterfaceListener::Threading NetworkInterfaceListener::threading() const
+{
+    return _threading;
+}
+
+
+void NetworkInterfaceListener::setPollInterval(uint64_t interval)
+{
+    _updateInterval = interval;
+}
+
+
+uint64_t NetworkInterfaceListener::getPollInterval() const
+{
+    return _updateInterval;
+}
+
+
+void NetworkInterfaceListener::setDamping(const DampingSettings& settings)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _dampingSettings = settings;
+}
+
+
+NetworkInterfaceListener::DampingSettings NetworkInterfaceListener::getDamping() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _dampingSettings;
+}
+
+
+NetworkInterfaceListener::Statistics NetworkInterfaceListener::statistics() const
+{
+    Statistics statistics;
+    statistics.rawEvents = _rawEvents;
+    statistics.deliveredEvents = _deliveredEvents;
+    statistics.suppressions = _suppressions;
+    return statistics;
+}
+
+
+std::size_t NetworkInterfaceListener::subscribe(const NetworkInterfaceFilter& filter,
+                                                Handler handler)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::shared_ptr<Subscriptions> subscriptions = _subscriptions
+        ? std::make_shared<Subscriptions>(*_subscriptions)
+        : std::make_shared<Subscriptions>();
+
+    Subscription subscription;
+    subscription.id = ++_lastSubscriptionId;
+    subscription.filter = filter;
+    subscription.handler = std::move(handler);
+    subscriptions->push_back(std::move(subscription));
+
+    _subscriptions = subscriptions;
+    return _lastSubscriptionId;
+}
+
+
+void NetworkInterfaceListener::unsubscribe(std::size_t id)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_subscriptions)
+        return;
+
+    auto subscriptions = std::make_shared<Subscriptions>(*_subscriptions);
+
+    subscriptions->erase(std::remove_if(subscriptions->begin(),
+                                        subscriptions->end(),
+                                        [id](const Subscription& subscription) {
+                                            return subscription.id == id;
+                                        }),
+                         subscriptions->end());
+
+    _subscriptions = subscriptions;
 }
 
 
@@ -0,0 +1,213 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/NetworkInterfaceQuery.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+NetworkInterfaceQuery::Result::Result()
+{
+}
+
+
+NetworkInterfaceQuery::Result::Result(std::shared_ptr<const NetworkInterfaceSnapshot> snapshot,
+                                      std::vector<View> views):
+    _snapshot(snapshot),
+    _views(std::move(views))
+{
+}
+
+
+NetworkInterfaceQuery::Result::const_iterator NetworkInterfaceQuery::Result::begin() const
+{
+    return _views.begin();
+}
+
+
+NetworkInterfaceQuery::Result::const_iterator NetworkInterfaceQuery::Result::end() const
+{
+    return _views.end();
+}
+
+
+std::size_t NetworkInterfaceQuery::Result::size() const
+{
+    return _views.size();
+}
+
+
+bool NetworkInterfaceQuery::Result::empty() const
+{
+    return _views.empty();
+}
+
+
+const NetworkInterfaceSnapshot::Address& NetworkInterfaceQuery::Result::operator [] (std::size_t index) const
+{
+    return _views[index];
+}
+
+
+std::shared_ptr<const NetworkInterfaceSnapshot> NetworkInterfaceQuery::Result::snapshot() const
+{
+    return _snapshot;
+}
+
+
+NetworkInterfaceQuery::NetworkInterfaceQuery():
+    _addressTypes(ANY_TYPE),
+    _families(ANY_FAMILY),
+    _states(ANY_STATE)
+{
+}
+
+
+NetworkInterfaceQuery& NetworkInterfaceQuery::setAddressTypes(uint32_t addressTypes)
+{
+    _addressTypes = addressTypes;
+    return *this;
+}
+
+
+NetworkInterfaceQuery& NetworkInterfaceQuery::setFamilies(uint32_t families)
+{
+    _families = families;
+    return *this;
+}
+
+
+NetworkInterfaceQuery& NetworkInterfaceQuery::setStates(uint32_t states)
+{
+    _states = states;
+    return *this;
+}
+
+
+NetworkInterfaceQuery& NetworkInterfaceQuery::addRange(const IPAddressRange& range)
+{
+    _ranges.push_back(range.compact());
+    return *this;
+}
+
+
+NetworkInterfaceQuery& NetworkInterfaceQuery::clearRanges()
+{
+    _ranges.clear();
+    return *this;
+}
+
+
+bool NetworkInterfaceQuery::matches(const NetworkInterfaceSnapshot::Address& address) const
+{
+    if ((address.addressTypes & _addressTypes) == 0)
+        return false;
+
+    const uint32_t family = address.compact.isIPv4() ? IPV4 : IPV6;
+
+    if ((family & _families) == 0)
+        return false;
+
+    const uint32_t state = address.interface->isUp ? UP : DOWN;
+
+    if ((state & _states) == 0)
+        return false;
+
+    if (_ranges.empty())
+        return true;
+
+    for (const auto& range: _ranges)
+    {
+        if (range.contains(address.compact))
+            return true;
+    }
+
+    return false;
+}
+
+
+NetworkInterfaceQuery::Result NetworkInterfaceQuery::run() const
+{
+    return run(NetworkInterfaceSnapshot::current());
+}
+
+
+NetworkInterfaceQuery::Result NetworkInterfaceQuery::run(std::shared_ptr<const NetworkInterfaceSnapshot> snapshot) const
+{
+    std::vector<View> views;
+
+    if (snapshot)
+    {
+        for (const auto& address: snapshot->addresses())
+        {
+            if (matches(address))
+                views.push_back(std::cref(address));
+        }
+    }
+
+    return Result(snapshot, std::move(views));
+}
+
+
+NetworkInterfaceQuery::Result NetworkInterfaceQuery::waitFor(std::chrono::milliseconds timeout) const
+{
+    auto snapshot = NetworkInterfaceSnapshot::waitFor([this](const NetworkInterfaceSnapshot& candidate) {
+        for (const auto& address: candidate.addresses())
+        {
+            if (matches(address))
+                return true;
+        }
+
+        return false;
+    }, timeout);
+
+    return snapshot ? run(snapshot) : Result();
+}
+
+
+std::future<NetworkInterfaceQuery::Result> NetworkInterfaceQuery::waitForAsync(std::chrono::milliseconds timeout) const
+{
+    NetworkInterfaceQuery query(*this);
+
+    return std::async(std::launch::async, [query, timeout]() {
+        return query.waitFor(timeout);
+    });
+}
+
+
+uint32_t NetworkInterfaceQuery::classify(const Poco::Net::IPAddress& address)
+{
+    uint32_t types = 0;
+
+    if (address.isWildcard())
+        types |= WILDCARD;
+
+    if (address.isBroadcast())
+        types |= BROADCAST;
+
+    if (address.isLoopback())
+        types |= LOOPBACK;
+
+    if (address.isMulticast())
+        types |= MULTICAST;
+
+    if (address.isUnicast())
+        types |= UNICAST;
+
+    if (address.isLinkLocal())
+        types |= LINK_LOCAL;
+
+    if (address.isSiteLocal())
+        types |= SITE_LOCAL;
+
+    return types;
+}
+
+
+} } // namespace ofx::Net
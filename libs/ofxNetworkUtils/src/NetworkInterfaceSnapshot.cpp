@@ -0,0 +1,724 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/NetworkInterfaceSnapshot.h"
+#include "ofx/Net/NetworkInterfaceQuery.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include "Poco/Exception.h"
+#include "ofConstants.h"
+#include "ofLog.h"
+
+
+#if defined(TARGET_WIN32)
+#include <winsock2.h>
+#include <ws2ipdef.h>
+#include <iphlpapi.h>
+#include <netioapi.h>
+#pragma comment(lib, "iphlpapi.lib")
+#elif defined(TARGET_LINUX) || defined(TARGET_ANDROID) || defined(TARGET_OSX) || defined(TARGET_OF_IOS)
+#define OFX_NET_WATCH_SOCKET
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#else
+#include <net/if.h>
+#include <net/route.h>
+#endif
+#endif
+
+
+namespace ofx {
+namespace Net {
+
+
+namespace {
+
+
+/// \brief Calls a function when the operating system reports an interface
+///        change.
+class ChangeWatcher
+{
+public:
+    explicit ChangeWatcher(std::function<void()> onChange);
+    ~ChangeWatcher();
+
+    /// \returns true iff changes are being reported.
+    bool isWatching() const;
+
+private:
+#if defined(TARGET_WIN32)
+    static VOID CALLBACK onInterfaceChange(PVOID context,
+                                           PMIB_IPINTERFACE_ROW row,
+                                           MIB_NOTIFICATION_TYPE type);
+
+    static VOID CALLBACK onAddressChange(PVOID context,
+                                         PMIB_UNICASTIPADDRESS_ROW row,
+                                         MIB_NOTIFICATION_TYPE type);
+
+    HANDLE _interfaceHandle = nullptr;
+    HANDLE _addressHandle = nullptr;
+#elif defined(OFX_NET_WATCH_SOCKET)
+    /// \brief The watcher thread function.
+    void run();
+
+    /// \returns true iff a message describes an interface or address change.
+    static bool isChange(const char* data, std::size_t size);
+
+    int _socket = -1;
+    int _wake[2] = { -1, -1 };
+    std::thread _thread;
+#endif
+
+    std::function<void()> _onChange;
+    bool _watching = false;
+
+};
+
+
+ChangeWatcher::ChangeWatcher(std::function<void()> onChange):
+    _onChange(onChange)
+{
+#if defined(TARGET_WIN32)
+    _watching = NotifyIpInterfaceChange(AF_UNSPEC, &onInterfaceChange, this, FALSE, &_interfaceHandle) == NO_ERROR
+             && NotifyUnicastIpAddressChange(AF_UNSPEC, &onAddressChange, this, FALSE, &_addressHandle) == NO_ERROR;
+
+    if (!_watching)
+        ofLogWarning("NetworkInterfaceSnapshot") << "Unable to register for interface change notifications.";
+#elif defined(OFX_NET_WATCH_SOCKET)
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+    _socket = ::socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+
+    if (_socket >= 0)
+    {
+        struct sockaddr_nl address;
+        std::memset(&address, 0, sizeof(address));
+        address.nl_family = AF_NETLINK;
+        address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+        if (::bind(_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            ::close(_socket);
+            _socket = -1;
+        }
+    }
+#else
+    _socket = ::socket(PF_ROUTE, SOCK_RAW, AF_UNSPEC);
+#endif
+
+    if (_socket >= 0 && ::pipe(_wake) == 0)
+    {
+        ::fcntl(_socket, F_SETFD, FD_CLOEXEC);
+        ::fcntl(_wake[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(_wake[1], F_SETFD, FD_CLOEXEC);
+
+        _thread = std::thread(&ChangeWatcher::run, this);
+        _watching = true;
+    }
+    else
+    {
+        ofLogWarning("NetworkInterfaceSnapshot") << "Unable to watch for interface changes: " << std::strerror(errno);
+    }
+#endif
+}
+
+
+ChangeWatcher::~ChangeWatcher()
+{
+#if defined(TARGET_WIN32)
+    if (_interfaceHandle)
+        CancelMibChangeNotify2(_interfaceHandle);
+
+    if (_addressHandle)
+        CancelMibChangeNotify2(_addressHandle);
+#elif defined(OFX_NET_WATCH_SOCKET)
+    if (_thread.joinable())
+    {
+        const char wake = 0;
+
+        if (::write(_wake[1], &wake, 1) == 1)
+            _thread.join();
+        else
+            _thread.detach();
+    }
+
+    for (int fd: { _socket, _wake[0], _wake[1] })
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+#endif
+}
+
+
+bool ChangeWatcher::isWatching() const
+{
+    return _watching;
+}
+
+
+#if defined(TARGET_WIN32)
+
+
+VOID CALLBACK ChangeWatcher::onInterfaceChange(PVOID context,
+                                               PMIB_IPINTERFACE_ROW,
+                                               MIB_NOTIFICATION_TYPE)
+{
+    static_cast<ChangeWatcher*>(context)->_onChange();
+}
+
+
+VOID CALLBACK ChangeWatcher::onAddressChange(PVOID context,
+                                             PMIB_UNICASTIPADDRESS_ROW,
+                                             MIB_NOTIFICATION_TYPE)
+{
+    static_cast<ChangeWatcher*>(context)->_onChange();
+}
+
+
+#elif defined(OFX_NET_WATCH_SOCKET)
+
+
+void ChangeWatcher::run()
+{
+    std::vector<char> buffer(16 * 1024);
+
+    struct pollfd fds[2];
+    fds[0].fd = _socket;
+    fds[0].events = POLLIN;
+    fds[1].fd = _wake[0];
+    fds[1].events = POLLIN;
+
+    while (true)
+    {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            ofLogError("NetworkInterfaceSnapshot") << "Stopped watching for interface changes: " << std::strerror(errno);
+            _onChange();
+            return;
+        }
+
+        if (fds[1].revents != 0)
+            return;
+
+        if (fds[0].revents == 0)
+            continue;
+
+        // Drain everything that is queued so a burst causes one rebuild.
+        bool changed = false;
+
+        while (true)
+        {
+            const ssize_t size = ::recv(_socket, buffer.data(), buffer.size(), MSG_DONTWAIT);
+
+            if (size > 0)
+            {
+                changed = changed || isChange(buffer.data(), static_cast<std::size_t>(size));
+            }
+            else if (size < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else
+            {
+                // ENOBUFS means messages were dropped, so assume a change.
+                changed = changed || (size < 0 && errno == ENOBUFS);
+                break;
+            }
+        }
+
+        if (changed)
+            _onChange();
+    }
+}
+
+
+bool ChangeWatcher::isChange(const char* data, std::size_t size)
+{
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+    const struct nlmsghdr* message = reinterpret_cast<const struct nlmsghdr*>(data);
+    int remaining = static_cast<int>(size);
+
+    for (; NLMSG_OK(message, remaining); message = NLMSG_NEXT(message, remaining))
+    {
+        if (message->nlmsg_type == RTM_NEWADDR || message->nlmsg_type == RTM_DELADDR || message->nlmsg_type == RTM_DELLINK)
+            return true;
+
+        if (message->nlmsg_type != RTM_NEWLINK)
+            continue;
+
+        // Wireless drivers send a steady stream of link messages that only
+        // carry wireless events. They do not change the interface list.
+        const struct ifinfomsg* info = static_cast<const struct ifinfomsg*>(NLMSG_DATA(message));
+        const struct rtattr* attribute = IFLA_RTA(info);
+        int length = static_cast<int>(IFLA_PAYLOAD(message));
+        bool wireless = false;
+
+        for (; RTA_OK(attribute, length); attribute = RTA_NEXT(attribute, length))
+        {
+            if (attribute->rta_type == IFLA_WIRELESS)
+                wireless = true;
+        }
+
+        if (!wireless)
+            return true;
+    }
+
+    return false;
+#else
+    if (size < sizeof(struct rt_msghdr))
+        return false;
+
+    switch (reinterpret_cast<const struct rt_msghdr*>(data)->rtm_type)
+    {
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+        case RTM_IFINFO:
+#if defined(RTM_IFANNOUNCE)
+        case RTM_IFANNOUNCE:
+#endif
+            return true;
+        default:
+            return false;
+    }
+#endif
+}
+
+
+#endif
+
+
+/// \brief Add bytes to a 64-bit FNV-1a hash.
+uint64_t hashBytes(uint64_t hash, const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+/// \brief Add an address to a 64-bit FNV-1a hash.
+uint64_t hashAddress(uint64_t hash, const Poco::Net::IPAddress& address)
+{
+    const Poco::UInt32 scope = address.scope();
+    hash = hashBytes(hash, address.addr(), address.length());
+    return hashBytes(hash, &scope, sizeof(scope));
+}
+
+
+/// \brief Wakes one waitFor() call when the snapshot is marked stale.
+struct ChangeWaiter
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool changed = false;
+};
+
+
+/// \brief Removes a change callback when it goes out of scope.
+class ChangeCallbackGuard
+{
+public:
+    explicit ChangeCallbackGuard(std::size_t id): _id(id)
+    {
+    }
+
+    ~ChangeCallbackGuard()
+    {
+        NetworkInterfaceSnapshot::removeChangeCallback(_id);
+    }
+
+private:
+    std::size_t _id;
+
+};
+
+
+/// \brief The process-wide snapshot state.
+struct SnapshotState
+{
+    SnapshotState(): stale(true)
+    {
+    }
+
+    /// \brief Serializes rebuilds.
+    std::mutex mutex;
+
+    /// \brief The current snapshot, read and written atomically.
+    std::shared_ptr<const NetworkInterfaceSnapshot> snapshot;
+
+    /// \brief True when the snapshot must be rebuilt before the next read.
+    std::atomic<bool> stale;
+
+    /// \brief The generation of the last snapshot.
+    uint64_t generation = 0;
+
+    /// \brief The enumerator, created with the first snapshot.
+    std::unique_ptr<NetworkInterfaceEnumerator> enumerator;
+
+    /// \brief The backend for the enumerator.
+    NetworkInterfaceEnumerator::Backend backend = NetworkInterfaceEnumerator::AUTOMATIC;
+
+    /// \brief Reused between rebuilds to keep its capacity.
+    NetworkInterfaceInfo::List interfaces;
+
+    /// \brief Serializes change callbacks and their registration.
+    std::mutex callbackMutex;
+
+    /// \brief The change callbacks by id.
+    std::map<std::size_t, NetworkInterfaceSnapshot::ChangeCallback> callbacks;
+
+    /// \brief The id of the last change callback.
+    std::size_t callbackId = 0;
+
+    /// \brief The change watcher, started with the first snapshot. Declared
+    ///        last so its thread is joined before the members it calls
+    ///        markStale() on are destroyed.
+    std::unique_ptr<ChangeWatcher> watcher;
+
+    /// \brief Mark the snapshot stale and call the change callbacks.
+    void markStale()
+    {
+        stale = true;
+
+        std::unique_lock<std::mutex> lock(callbackMutex);
+
+        for (const auto& entry: callbacks)
+            entry.second();
+    }
+};
+
+
+SnapshotState& snapshotState()
+{
+    static SnapshotState state;
+    return state;
+}
+
+
+std::shared_ptr<const NetworkInterfaceSnapshot> rebuild(bool force)
+{
+    SnapshotState& state = snapshotState();
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+
+    if (!state.watcher)
+        state.watcher.reset(new ChangeWatcher([&state]() { state.markStale(); }));
+
+    std::shared_ptr<const NetworkInterfaceSnapshot> snapshot = std::atomic_load(&state.snapshot);
+
+    // Another thread may have rebuilt it while this one waited.
+    if (!force && snapshot && !state.stale)
+        return snapshot;
+
+    // Clear the flag first so a change during enumeration is not lost.
+    state.stale = false;
+
+    if (!state.enumerator)
+        state.enumerator.reset(new NetworkInterfaceEnumerator(state.backend));
+
+    if (!state.enumerator->enumerate(state.interfaces))
+    {
+        if (snapshot)
+            return snapshot;
+
+        state.interfaces.clear();
+    }
+
+    snapshot = std::make_shared<const NetworkInterfaceSnapshot>(state.interfaces, ++state.generation);
+
+    std::atomic_store(&state.snapshot, snapshot);
+    return snapshot;
+}
+
+
+} // namespace
+
+
+NetworkInterfaceSnapshot::NetworkInterfaceSnapshot(NetworkInterfaceInfo::List interfaces,
+                                                   uint64_t generation,
+                                                   bool system):
+    _interfaces(std::move(interfaces)),
+    _generation(generation),
+    _created(Clock::now()),
+    _system(system)
+{
+    _fingerprints.reserve(_interfaces.size());
+
+    for (const auto& info: _interfaces)
+    {
+        _fingerprints.push_back(fingerprint(info));
+
+        for (const auto& entry: info.addresses)
+        {
+            Address record;
+            record.interface = &info;
+            record.address = entry.address;
+            record.compact = CompactIPAddress(entry.address);
+            record.addressTypes = NetworkInterfaceQuery::classify(entry.address);
+            _addresses.push_back(record);
+        }
+    }
+}
+
+
+const NetworkInterfaceInfo::List& NetworkInterfaceSnapshot::interfaces() const
+{
+    return _interfaces;
+}
+
+
+const std::vector<uint64_t>& NetworkInterfaceSnapshot::fingerprints() const
+{
+    return _fingerprints;
+}
+
+
+const Poco::Net::NetworkInterface::List& NetworkInterfaceSnapshot::list() const
+{
+    std::call_once(_pocoOnce, &NetworkInterfaceSnapshot::buildPoco, this);
+    return _list;
+}
+
+
+const Poco::Net::NetworkInterface::Map& NetworkInterfaceSnapshot::map() const
+{
+    std::call_once(_pocoOnce, &NetworkInterfaceSnapshot::buildPoco, this);
+    return _map;
+}
+
+
+void NetworkInterfaceSnapshot::buildPoco() const
+{
+    if (!_system)
+        return;
+
+    try
+    {
+        _list = Poco::Net::NetworkInterface::list();
+        _map = Poco::Net::NetworkInterface::map();
+    }
+    catch (const Poco::Exception& exc)
+    {
+        ofLogError("NetworkInterfaceSnapshot::list") << exc.displayText();
+    }
+}
+
+
+const std::vector<NetworkInterfaceSnapshot::Address>& NetworkInterfaceSnapshot::addresses() const
+{
+    return _addresses;
+}
+
+
+uint64_t NetworkInterfaceSnapshot::generation() const
+{
+    return _generation;
+}
+
+
+NetworkInterfaceSnapshot::Clock::time_point NetworkInterfaceSnapshot::created() const
+{
+    return _created;
+}
+
+
+bool NetworkInterfaceSnapshot::isSystem() const
+{
+    return _system;
+}
+
+
+std::shared_ptr<const NetworkInterfaceSnapshot> NetworkInterfaceSnapshot::current()
+{
+    SnapshotState& state = snapshotState();
+
+    std::shared_ptr<const NetworkInterfaceSnapshot> snapshot = std::atomic_load(&state.snapshot);
+
+    if (snapshot && !state.stale.load(std::memory_order_acquire))
+        return snapshot;
+
+    return rebuild(false);
+}
+
+
+std::shared_ptr<const NetworkInterfaceSnapshot> NetworkInterfaceSnapshot::refresh()
+{
+    return rebuild(true);
+}
+
+
+void NetworkInterfaceSnapshot::invalidate()
+{
+    snapshotState().markStale();
+}
+
+
+bool NetworkInterfaceSnapshot::isWatching()
+{
+    // The watcher starts with the first snapshot.
+    current();
+
+    SnapshotState& state = snapshotState();
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    return state.watcher && state.watcher->isWatching();
+}
+
+
+std::size_t NetworkInterfaceSnapshot::addChangeCallback(ChangeCallback callback)
+{
+    SnapshotState& state = snapshotState();
+
+    std::unique_lock<std::mutex> lock(state.callbackMutex);
+    state.callbacks[++state.callbackId] = callback;
+    return state.callbackId;
+}
+
+
+void NetworkInterfaceSnapshot::removeChangeCallback(std::size_t id)
+{
+    SnapshotState& state = snapshotState();
+
+    std::unique_lock<std::mutex> lock(state.callbackMutex);
+    state.callbacks.erase(id);
+}
+
+
+std::shared_ptr<const NetworkInterfaceSnapshot> NetworkInterfaceSnapshot::waitFor(Predicate predicate,
+                                                                                std::chrono::milliseconds timeout)
+{
+    const Clock::time_point now = Clock::now();
+
+    // Saturated so that milliseconds::max() waits indefinitely.
+    const Clock::time_point deadline = timeout < std::chrono::duration_cast<std::chrono::milliseconds>(Clock::time_point::max() - now)
+                                     ? now + timeout
+                                     : Clock::time_point::max();
+    const bool watching = isWatching();
+
+    auto waiter = std::make_shared<ChangeWaiter>();
+
+    ChangeCallbackGuard guard(addChangeCallback([waiter]() {
+        {
+            std::unique_lock<std::mutex> lock(waiter->mutex);
+            waiter->changed = true;
+        }
+
+        waiter->condition.notify_one();
+    }));
+
+    while (true)
+    {
+        {
+            // Cleared before reading so a change during the test is not lost.
+            std::unique_lock<std::mutex> lock(waiter->mutex);
+            waiter->changed = false;
+        }
+
+        std::shared_ptr<const NetworkInterfaceSnapshot> snapshot = watching ? current() : refresh();
+
+        if (predicate(*snapshot))
+            return snapshot;
+
+        std::unique_lock<std::mutex> lock(waiter->mutex);
+
+        if (watching && deadline == Clock::time_point::max())
+        {
+            waiter->condition.wait(lock, [&waiter]() { return waiter->changed; });
+        }
+        else if (watching)
+        {
+            if (!waiter->condition.wait_until(lock, deadline, [&waiter]() { return waiter->changed; }))
+                return nullptr;
+        }
+        else
+        {
+            if (Clock::now() >= deadline)
+                return nullptr;
+
+            waiter->condition.wait_until(lock, std::min(deadline, Clock::now() + std::chrono::milliseconds(DEFAULT_WAIT_POLL_INTERVAL)));
+        }
+    }
+}
+
+
+std::future<std::shared_ptr<const NetworkInterfaceSnapshot>> NetworkInterfaceSnapshot::waitForAsync(Predicate predicate,
+                                                                                                   std::chrono::milliseconds timeout)
+{
+    return std::async(std::launch::async, [predicate, timeout]() {
+        return waitFor(predicate, timeout);
+    });
+}
+
+
+void NetworkInterfaceSnapshot::setBackend(NetworkInterfaceEnumerator::Backend backend)
+{
+    SnapshotState& state = snapshotState();
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.backend = backend;
+    state.enumerator.reset();
+    state.stale = true;
+}
+
+
+uint64_t NetworkInterfaceSnapshot::fingerprint(const NetworkInterfaceInfo& info)
+{
+    const uint64_t basis = 14695981039346656037ULL;
+
+    const unsigned char flags[] = {
+        info.isUp,
+        info.isRunning,
+        info.isLoopback,
+        info.isPointToPoint,
+        info.supportsBroadcast,
+        info.supportsMulticast
+    };
+
+    uint64_t hash = hashBytes(basis, flags, sizeof(flags));
+    hash = hashBytes(hash, &info.mtu, sizeof(info.mtu));
+    hash = hashBytes(hash, info.macAddress.data(), info.macAddress.size());
+
+    // Summed so the order of the addresses does not matter.
+    uint64_t addresses = 0;
+
+    for (const auto& entry: info.addresses)
+    {
+        uint64_t address = hashAddress(basis, entry.address);
+        address = hashAddress(address, entry.subnetMask);
+        address = hashAddress(address, entry.broadcastAddress);
+        addresses += address;
+    }
+
+    return hashBytes(hash, &addresses, sizeof(addresses));
+}
+
+
+} } // namespace ofx::Net
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/NetworkInterfaceSource.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+namespace {
+
+
+/// \brief The interfaces of this system, through NetworkInterfaceSnapshot.
+class SystemNetworkInterfaceSource: public NetworkInterfaceSource
+{
+public:
+    std::shared_ptr<const NetworkInterfaceSnapshot> current() override
+    {
+        return NetworkInterfaceSnapshot::current();
+    }
+
+    std::shared_ptr<const NetworkInterfaceSnapshot> refresh() override
+    {
+        return NetworkInterfaceSnapshot::refresh();
+    }
+
+    bool isWatching() const override
+    {
+        return NetworkInterfaceSnapshot::isWatching();
+    }
+
+    std::size_t addChangeCallback(ChangeCallback callback) override
+    {
+        return NetworkInterfaceSnapshot::addChangeCallback(callback);
+    }
+
+    void removeChangeCallback(std::size_t id) override
+    {
+        NetworkInterfaceSnapshot::removeChangeCallback(id);
+    }
+
+};
+
+
+} // namespace
+
+
+NetworkInterfaceSource::~NetworkInterfaceSource()
+{
+}
+
+
+std::shared_ptr<NetworkInterfaceSource> NetworkInterfaceSource::system()
+{
+    static const std::shared_ptr<NetworkInterfaceSource> source = std::make_shared<SystemNetworkInterfaceSource>();
+    return source;
+}
+
+
+} } // namespace ofx::Net
@@ -6,6 +6,7 @@
 
 
 #include "ofx/Net/NetworkUtils.h"
+#include <mutex>
 #include "Poco/Environment.h"
 #include "Poco/Exception.h"
 #include "Poco/StreamCopier.h"
@@ -22,6 +23,35 @@ namespace Net {
 const std::string NetworkUtils::DEFAULT_PUBLIC_IP_QUERY_URL = "https://api.ipify.org";
 
 
+namespace {
+
+
+std::mutex hostResolverMutex;
+std::shared_ptr<AsyncHostResolver> hostResolver;
+
+std::mutex hostEntryCacheMutex;
+std::shared_ptr<HostEntryCache> hostEntryCache;
+
+std::mutex hostResolverBackendMutex;
+AsyncHostResolver::Backend hostResolverBackend;
+
+
+NetworkUtils::HostEntry resolveCached(HostEntryCache& cache,
+                                      const HostEntryCache::Query& query,
+                                      const std::string& module)
+{
+    HostEntryCache::Result result = cache.resolve(query, NetworkUtils::getHostResolverBackend());
+
+    if (!result.success())
+        ofLogError(module) << result.message;
+
+    return result.hostEntry;
+}
+
+
+} // namespace
+
+
 std::string NetworkUtils::getHostName()
 {
     std::string nodeName = "UNKNOWN";
@@ -86,11 +116,16 @@ std::string NetworkUtils::getMacAddress()
 
 NetworkUtils::HostEntry NetworkUtils::getHostByName(const std::string& hostname)
 {
+    std::shared_ptr<HostEntryCache> cache = getHostEntryCache();
+
+    if (cache)
+        return resolveCached(*cache, { AsyncHostResolver::QueryType::HOST_BY_NAME, hostname }, "NetworkUtils::getHostByName");
+
     NetworkUtils::HostEntry hostEntry;
 
     try
     {
-        hostEntry = Poco::Net::DNS::hostByName(hostname);
+        hostEntry = getHostResolverBackend()({ AsyncHostResolver::QueryType::HOST_BY_NAME, hostname });
     }
     catch (const Poco::Net::HostNotFoundException& exc)
     {
@@ -123,11 +158,16 @@ NetworkUtils::HostEntry NetworkUtils::getHostByName(const std::string& hostname)
 
 NetworkUtils::HostEntry NetworkUtils::getHostByAddress(const Poco::Net::IPAddress& ipAddress)
 {
+    std::shared_ptr<HostEntryCache> cache = getHostEntryCache();
+
+    if (cache)
+        return resolveCached(*cache, { AsyncHostResolver::QueryType::HOST_BY_ADDRESS, ipAddress.toString() }, "NetworkUtils::getHostByAddress");
+
     NetworkUtils::HostEntry hostEntry;
 
     try
     {
-        hostEntry = Poco::Net::DNS::hostByAddress(ipAddress);
+        hostEntry = getHostResolverBackend()({ AsyncHostResolver::QueryType::HOST_BY_ADDRESS, ipAddress.toString() });
     }
     catch (const Poco::Net::HostNotFoundException& exc)
     {
@@ -156,11 +196,16 @@ NetworkUtils::HostEntry NetworkUtils::getHostByAddress(const Poco::Net::IPAddres
 
 NetworkUtils::HostEntry NetworkUtils::getHost(const std::string& address)
 {
+    std::shared_ptr<HostEntryCache> cache = getHostEntryCache();
+
+    if (cache)
+        return resolveCached(*cache, { AsyncHostResolver::QueryType::RESOLVE, address }, "NetworkUtils::getHost");
+
     NetworkUtils::HostEntry hostEntry;
 
     try
     {
-        hostEntry = Poco::Net::DNS::resolve(address);
+        hostEntry = getHostResolverBackend()({ AsyncHostResolver::QueryType::RESOLVE, address });
     }
     catch (const Poco::Net::HostNotFoundException& exc)
     {
@@ -193,7 +238,7 @@ NetworkUtils::HostEntry NetworkUtils::getThisHost()
 
     try
     {
-        hostEntry = Poco::Net::DNS::thisHost();
+        hostEntry = getHostResolverBackend()({ AsyncHostResolver::QueryType::THIS_HOST, "" });
     }
     catch (const Poco::Net::HostNotFoundException& exc)
     {
@@ -224,11 +269,149 @@ NetworkUtils::HostEntry NetworkUtils::getThisHost()
     return hostEntry;
 }
 
+
+std::vector<AsyncHostResolver::Result> NetworkUtils::getHostsByAddress(const std::vector<Poco::Net::IPAddress>& addresses,
+                                                                      std::size_t maximumInFlight)
+{
+    std::shared_ptr<AsyncHostResolver> resolver = getHostResolver();
+    std::shared_ptr<HostEntryCache> cache = getHostEntryCache();
+
+    std::vector<AsyncHostResolver::Query> queries;
+    queries.reserve(addresses.size());
+
+    for (const auto& address: addresses)
+        queries.push_back({ AsyncHostResolver::QueryType::HOST_BY_ADDRESS, address.toString() });
+
+    if (!cache)
+        return resolver->resolveAll(queries, maximumInFlight, resolver->settings().defaultTimeout);
+
+    std::vector<AsyncHostResolver::Result> results(queries.size());
+    std::vector<AsyncHostResolver::Query> misses;
+    std::vector<std::size_t> missIndices;
+
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        if (!cache->find(queries[i], results[i]))
+        {
+            misses.push_back(queries[i]);
+            missIndices.push_back(i);
+        }
+    }
+
+    std::vector<AsyncHostResolver::Result> resolved = resolver->resolveAll(misses,
+                                                                           maximumInFlight,
+                                                                           resolver->settings().defaultTimeout);
+
+    for (std::size_t i = 0; i < resolved.size(); ++i)
+    {
+        cache->insert(misses[i], resolved[i]);
+        results[missIndices[i]] = resolved[i];
+    }
+
+    return results;
+}
+
+
+AsyncHostResolver::Request NetworkUtils::getHostByNameAsync(const std::string& hostname,
+                                                           AsyncHostResolver::Callback callback)
+{
+    return getHostResolver()->getHostByName(hostname, callback);
+}
+
+
+AsyncHostResolver::Request NetworkUtils::getHostByAddressAsync(const Poco::Net::IPAddress& ipAddress,
+                                                              AsyncHostResolver::Callback callback)
+{
+    return getHostResolver()->getHostByAddress(ipAddress, callback);
+}
+
+
+AsyncHostResolver::Request NetworkUtils::getHostAsync(const std::string& address,
+                                                     AsyncHostResolver::Callback callback)
+{
+    return getHostResolver()->getHost(address, callback);
+}
+
+
+AsyncHostResolver::Request NetworkUtils::getThisHostAsync(AsyncHostResolver::Callback callback)
+{
+    return getHostResolver()->getThisHost(callback);
+}
+
+
+std::shared_ptr<AsyncHostResolver> NetworkUtils::getHostResolver()
+{
+    std::unique_lock<std::mutex> lock(hostResolverMutex);
+
+    if (!hostResolver)
+    {
+        AsyncHostResolver::Settings settings;
+        settings.backend = getHostResolverBackend();
+        hostResolver = std::make_shared<AsyncHostResolver>(settings);
+    }
+
+    return hostResolver;
+}
+
+
+void NetworkUtils::setHostResolver(std::shared_ptr<AsyncHostResolver> resolver)
+{
+    std::shared_ptr<AsyncHostResolver> previous;
+
+    {
+        std::unique_lock<std::mutex> lock(hostResolverMutex);
+        previous = hostResolver;
+        hostResolver = resolver;
+    }
+
+    // The previous resolver is released outside of the lock because its
+    // destructor waits for running lookups.
+}
+
+
+AsyncHostResolver::Backend NetworkUtils::getHostResolverBackend()
+{
+    std::unique_lock<std::mutex> lock(hostResolverBackendMutex);
+
+    if (!hostResolverBackend)
+        hostResolverBackend = AsyncHostResolver::systemBackend();
+
+    return hostResolverBackend;
+}
+
+
+void NetworkUtils::setHostResolverBackend(AsyncHostResolver::Backend backend)
+{
+    std::unique_lock<std::mutex> lock(hostResolverBackendMutex);
+    hostResolverBackend = backend;
+}
+
+
+std::shared_ptr<HostEntryCache> NetworkUtils::getHostEntryCache()
+{
+    std::unique_lock<std::mutex> lock(hostEntryCacheMutex);
+    return hostEntryCache;
+}
+
+
+void NetworkUtils::setHostEntryCache(std::shared_ptr<HostEntryCache> cache)
+{
+    std::shared_ptr<HostEntryCache> previous;
+
+    {
+        std::unique_lock<std::mutex> lock(hostEntryCacheMutex);
+        previous = hostEntryCache;
+        hostEntryCache = cache;
+    }
+}
+
+
 NetworkUtils::NetworkInterfaceList NetworkUtils::listNetworkInterfaces(AddressType addressType,
                                                                        NetworkInterface::IPVersion ipVersion)
 {
     NetworkInterfaceList results;
-    auto all = Poco::Net::NetworkInterface::list();
+    auto snapshot = NetworkInterfaceSnapshot::current();
+    const auto& all = snapshot->list();
     auto iter = all.begin();
 
     while (iter != all.end())
@@ -283,6 +466,38 @@ NetworkUtils::NetworkInterfaceList NetworkUtils::listNetworkInterfaces(AddressTy
 }
 
 
+NetworkInterfaceQuery::Result NetworkUtils::findNetworkInterfaces(const NetworkInterfaceQuery& query)
+{
+    return query.run();
+}
+
+
+uint32_t NetworkUtils::toAddressTypes(AddressType addressType)
+{
+    switch (addressType)
+    {
+        case ANY:
+            return NetworkInterfaceQuery::ANY_TYPE;
+        case WILDCARD:
+            return NetworkInterfaceQuery::WILDCARD;
+        case BROADCAST:
+            return NetworkInterfaceQuery::BROADCAST;
+        case LOOPBACK:
+            return NetworkInterfaceQuery::LOOPBACK;
+        case MULTICAST:
+            return NetworkInterfaceQuery::MULTICAST;
+        case UNICAST:
+            return NetworkInterfaceQuery::UNICAST;
+        case LINK_LOCAL:
+            return NetworkInterfaceQuery::LINK_LOCAL;
+        case SITE_LOCAL:
+            return NetworkInterfaceQuery::SITE_LOCAL;
+    }
+
+    return NetworkInterfaceQuery::ANY_TYPE;
+}
+
+
 Poco::Net::IPAddress NetworkUtils::getPublicIPAddress(const std::string& url)
 {
     try
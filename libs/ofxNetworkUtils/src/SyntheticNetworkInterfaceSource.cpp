@@ -0,0 +1,576 @@
+//
+// Copyright (c) 2013 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier: MIT
+//
+
+
+#include "ofx/Net/SyntheticNetworkInterfaceSource.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace Net {
+
+
+namespace {
+
+
+const char* const RECORDING_HEADER = "ofxNetworkUtils-interfaces";
+const int RECORDING_VERSION = 1;
+
+
+/// \brief Orders interfaces by index.
+bool byIndex(const NetworkInterfaceInfo& lhs, const NetworkInterfaceInfo& rhs)
+{
+    return lhs.index < rhs.index;
+}
+
+
+/// \brief Make an IP address from a string known to be valid.
+Poco::Net::IPAddress parseAddress(const std::string& text)
+{
+    return Poco::Net::IPAddress(text);
+}
+
+
+std::string formatFlags(const NetworkInterfaceInfo& info)
+{
+    std::string flags;
+
+    if (info.isUp) flags += 'U';
+    if (info.isRunning) flags += 'R';
+    if (info.isLoopback) flags += 'L';
+    if (info.isPointToPoint) flags += 'P';
+    if (info.supportsBroadcast) flags += 'B';
+    if (info.supportsMulticast) flags += 'M';
+
+    return flags.empty() ? "-" : flags;
+}
+
+
+void parseFlags(const std::string& flags, NetworkInterfaceInfo& info)
+{
+    info.isUp = flags.find('U') != std::string::npos;
+    info.isRunning = flags.find('R') != std::string::npos;
+    info.isLoopback = flags.find('L') != std::string::npos;
+    info.isPointToPoint = flags.find('P') != std::string::npos;
+    info.supportsBroadcast = flags.find('B') != std::string::npos;
+    info.supportsMulticast = flags.find('M') != std::string::npos;
+}
+
+
+std::string formatMACAddress(const std::vector<unsigned char>& macAddress)
+{
+    if (macAddress.empty())
+        return "-";
+
+    std::string text;
+
+    for (std::size_t i = 0; i < macAddress.size(); ++i)
+    {
+        char octet[4];
+        std::snprintf(octet, sizeof(octet), i == 0 ? "%02x" : ":%02x", macAddress[i]);
+        text += octet;
+    }
+
+    return text;
+}
+
+
+bool parseMACAddress(const std::string& text, std::vector<unsigned char>& macAddress)
+{
+    macAddress.clear();
+
+    if (text == "-")
+        return true;
+
+    std::istringstream stream(text);
+    std::string octet;
+
+    while (std::getline(stream, octet, ':'))
+    {
+        char* end = nullptr;
+        unsigned long value = std::strtoul(octet.c_str(), &end, 16);
+
+        if (octet.empty() || *end != '\0' || value > 0xFF)
+            return false;
+
+        macAddress.push_back(static_cast<unsigned char>(value));
+    }
+
+    return true;
+}
+
+
+void writeInterface(std::ostream& stream, const NetworkInterfaceInfo& info)
+{
+    stream << "interface "
+           << info.index << " "
+           << info.name << " "
+           << info.mtu << " "
+           << formatFlags(info) << " "
+           << formatMACAddress(info.macAddress) << " "
+           << info.addresses.size() << "\n";
+
+    for (const auto& entry: info.addresses)
+    {
+        stream << entry.address.toString() << " "
+               << entry.subnetMask.toString() << " "
+               << entry.broadcastAddress.toString() << "\n";
+    }
+}
+
+
+bool readInterface(std::istream& stream, NetworkInterfaceInfo& info)
+{
+    std::string keyword;
+    std::string flags;
+    std::string macAddress;
+    std::size_t count = 0;
+
+    if (!(stream >> keyword >> info.index >> info.name >> info.mtu >> flags >> macAddress >> count)
+     || keyword != "interface"
+     || !parseMACAddress(macAddress, info.macAddress))
+    {
+        return false;
+    }
+
+    parseFlags(flags, info);
+
+    info.addresses.resize(count);
+
+    for (auto& entry: info.addresses)
+    {
+        std::string address;
+        std::string subnetMask;
+        std::string broadcastAddress;
+
+        if (!(stream >> address >> subnetMask >> broadcastAddress)
+         || !Poco::Net::IPAddress::tryParse(address, entry.address)
+         || !Poco::Net::IPAddress::tryParse(subnetMask, entry.subnetMask)
+         || !Poco::Net::IPAddress::tryParse(broadcastAddress, entry.broadcastAddress))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+} // namespace
+
+
+SyntheticNetworkInterfaceSource::SyntheticNetworkInterfaceSource():
+    SyntheticNetworkInterfaceSource(NetworkInterfaceInfo::List())
+{
+}
+
+
+SyntheticNetworkInterfaceSource::SyntheticNetworkInterfaceSource(NetworkInterfaceInfo::List interfaces)
+{
+    std::sort(interfaces.begin(), interfaces.end(), byIndex);
+    _snapshot = std::make_shared<NetworkInterfaceSnapshot>(std::move(interfaces), ++_generation, false);
+}
+
+
+std::shared_ptr<const NetworkInterfaceSnapshot> SyntheticNetworkInterfaceSource::current()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _snapshot;
+}
+
+
+std::shared_ptr<const NetworkInterfaceSnapshot> SyntheticNetworkInterfaceSource::refresh()
+{
+    return current();
+}
+
+
+bool SyntheticNetworkInterfaceSource::isWatching() const
+{
+    return true;
+}
+
+
+std::size_t SyntheticNetworkInterfaceSource::addChangeCallback(ChangeCallback callback)
+{
+    std::unique_lock<std::mutex> lock(_callbackMutex);
+    _callbacks[++_lastCallbackId] = callback;
+    return _lastCallbackId;
+}
+
+
+void SyntheticNetworkInterfaceSource::removeChangeCallback(std::size_t id)
+{
+    std::unique_lock<std::mutex> lock(_callbackMutex);
+    _callbacks.erase(id);
+}
+
+
+void SyntheticNetworkInterfaceSource::publish(NetworkInterfaceInfo::List interfaces)
+{
+    std::sort(interfaces.begin(), interfaces.end(), byIndex);
+
+    auto snapshot = std::make_shared<NetworkInterfaceSnapshot>(std::move(interfaces), ++_generation, false);
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _snapshot = snapshot;
+    }
+
+    std::unique_lock<std::mutex> lock(_callbackMutex);
+
+    for (const auto& callback: _callbacks)
+        callback.second();
+}
+
+
+void SyntheticNetworkInterfaceSource::apply(const Change& change)
+{
+    NetworkInterfaceInfo::List interfaces = current()->interfaces();
+    apply(interfaces, change);
+    publish(std::move(interfaces));
+}
+
+
+void SyntheticNetworkInterfaceSource::play(Recording recording)
+{
+    NetworkInterfaceInfo::List initial;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _recording = std::move(recording);
+        _position = 0;
+        initial = _recording.initial;
+    }
+
+    publish(std::move(initial));
+}
+
+
+bool SyntheticNetworkInterfaceSource::step()
+{
+    const Change* change = nullptr;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (_position == _recording.changes.size())
+            return false;
+
+        change = &_recording.changes[_position++];
+    }
+
+    // The recording is only replaced by play(), which is not concurrent.
+    apply(*change);
+    return true;
+}
+
+
+std::size_t SyntheticNetworkInterfaceSource::remaining() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _recording.changes.size() - _position;
+}
+
+
+NetworkInterfaceInfo SyntheticNetworkInterfaceSource::generateInterface(unsigned index)
+{
+    const unsigned high = (index >> 8) & 0xFF;
+    const unsigned low = index & 0xFF;
+
+    NetworkInterfaceInfo info;
+    info.index = index;
+    info.name = "syn" + std::to_string(index);
+    info.macAddress = { 0x02, 0x00, 0x00, 0x00, static_cast<unsigned char>(high), static_cast<unsigned char>(low) };
+    info.mtu = 1500;
+    info.isUp = true;
+    info.isRunning = true;
+    info.supportsBroadcast = true;
+    info.supportsMulticast = true;
+
+    NetworkInterfaceInfo::AddressInfo ipv4;
+    ipv4.address = parseAddress("10." + std::to_string(high) + "." + std::to_string(low) + ".1");
+    ipv4.subnetMask = parseAddress("255.255.255.0");
+    ipv4.broadcastAddress = parseAddress("10." + std::to_string(high) + "." + std::to_string(low) + ".255");
+    info.addresses.push_back(ipv4);
+
+    char ipv6[40];
+    std::snprintf(ipv6, sizeof(ipv6), "fd00:0:%x:%x::1", high, low);
+
+    NetworkInterfaceInfo::AddressInfo ipv6Entry;
+    ipv6Entry.address = parseAddress(ipv6);
+    ipv6Entry.subnetMask = parseAddress("ffff:ffff:ffff:ffff::");
+    ipv6Entry.broadcastAddress = Poco::Net::IPAddress(Poco::Net::IPAddress::IPv6);
+    info.addresses.push_back(ipv6Entry);
+
+    return info;
+}
+
+
+NetworkInterfaceInfo::List SyntheticNetworkInterfaceSource::generate(std::size_t count)
+{
+    NetworkInterfaceInfo::List interfaces;
+    interfaces.reserve(count);
+
+    for (std::size_t i = 1; i <= count; ++i)
+        interfaces.push_back(generateInterface(static_cast<unsigned>(i)));
+
+    return interfaces;
+}
+
+
+SyntheticNetworkInterfaceSource::Recording SyntheticNetworkInterfaceSource::generate(std::size_t count,
+                                                                                     std::size_t changes,
+                                                                                     uint32_t seed)
+{
+    // minstd_rand is fully specified, so recordings match across platforms.
+    std::minstd_rand random(seed);
+
+    Recording recording;
+    recording.initial = generate(count);
+
+    NetworkInterfaceInfo::List state = recording.initial;
+    unsigned nextIndex = static_cast<unsigned>(count) + 1;
+    unsigned nextAddress = 0;
+
+    for (std::size_t i = 0; i < changes; ++i)
+    {
+        Change change;
+        const unsigned kind = random() % 6;
+
+        // Indices are not reused, like the kernel, so once they run out
+        // interfaces are no longer added. The list is never empty by then.
+        if ((kind == 5 || state.empty()) && nextIndex <= 0xFFFF)
+        {
+            change.updated.push_back(generateInterface(nextIndex++));
+        }
+        else if (kind == 4 && state.size() > 1)
+        {
+            change.removed.push_back(state[random() % state.size()].index);
+        }
+        else
+        {
+            NetworkInterfaceInfo info = state[random() % state.size()];
+
+            if (kind == 0 || (kind == 1 && info.addresses.empty()))
+            {
+                ++nextAddress;
+
+                NetworkInterfaceInfo::AddressInfo entry;
+                entry.address = parseAddress("172." + std::to_string(16 + ((nextAddress >> 16) & 0x0F)) + "." + std::to_string((nextAddress >> 8) & 0xFF) + "." + std::to_string(nextAddress & 0xFF));
+                entry.subnetMask = parseAddress("255.240.0.0");
+                entry.broadcastAddress = parseAddress("172.31.255.255");
+                info.addresses.push_back(entry);
+            }
+            else if (kind == 1)
+            {
+                info.addresses.pop_back();
+            }
+            else if (kind == 2)
+            {
+                info.isRunning = !info.isRunning;
+            }
+            else
+            {
+                info.mtu = 1280 + random() % 7720;
+            }
+
+            change.updated.push_back(info);
+        }
+
+        apply(state, change);
+        recording.changes.push_back(std::move(change));
+    }
+
+    return recording;
+}
+
+
+SyntheticNetworkInterfaceSource::Change SyntheticNetworkInterfaceSource::difference(const NetworkInterfaceInfo::List& before,
+                                                                                    const NetworkInterfaceInfo::List& after)
+{
+    Change change;
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    while (i < before.size() || j < after.size())
+    {
+        if (j == after.size() || (i < before.size() && before[i].index < after[j].index))
+        {
+            change.removed.push_back(before[i].index);
+            ++i;
+        }
+        else if (i == before.size() || after[j].index < before[i].index)
+        {
+            change.updated.push_back(after[j]);
+            ++j;
+        }
+        else
+        {
+            if (before[i].name != after[j].name
+             || NetworkInterfaceSnapshot::fingerprint(before[i]) != NetworkInterfaceSnapshot::fingerprint(after[j]))
+            {
+                change.updated.push_back(after[j]);
+            }
+
+            ++i;
+            ++j;
+        }
+    }
+
+    return change;
+}
+
+
+void SyntheticNetworkInterfaceSource::apply(NetworkInterfaceInfo::List& interfaces,
+                                            const Change& change)
+{
+    for (unsigned index: change.removed)
+    {
+        NetworkInterfaceInfo key;
+        key.index = index;
+
+        auto iter = std::lower_bound(interfaces.begin(), interfaces.end(), key, byIndex);
+
+        if (iter != interfaces.end() && iter->index == index)
+            interfaces.erase(iter);
+    }
+
+    for (const auto& info: change.updated)
+    {
+        auto iter = std::lower_bound(interfaces.begin(), interfaces.end(), info, byIndex);
+
+        if (iter != interfaces.end() && iter->index == info.index)
+            *iter = info;
+        else
+            interfaces.insert(iter, info);
+    }
+}
+
+
+bool SyntheticNetworkInterfaceSource::save(const std::string& path,
+                                           const Recording& recording)
+{
+    std::ofstream stream(path.c_str());
+
+    if (!stream)
+    {
+        ofLogError("SyntheticNetworkInterfaceSource::save") << "Unable to open " << path;
+        return false;
+    }
+
+    stream << RECORDING_HEADER << " " << RECORDING_VERSION << "\n";
+    stream << "initial " << recording.initial.size() << "\n";
+
+    for (const auto& info: recording.initial)
+        writeInterface(stream, info);
+
+    for (const auto& change: recording.changes)
+    {
+        stream << "change " << change.updated.size() << " " << change.removed.size();
+
+        for (unsigned index: change.removed)
+            stream << " " << index;
+
+        stream << "\n";
+
+        for (const auto& info: change.updated)
+            writeInterface(stream, info);
+    }
+
+    return static_cast<bool>(stream);
+}
+
+
+bool SyntheticNetworkInterfaceSource::load(const std::string& path,
+                                           Recording& recording)
+{
+    recording = Recording();
+
+    std::ifstream stream(path.c_str());
+
+    if (!stream)
+    {
+        ofLogError("SyntheticNetworkInterfaceSource::load") << "Unable to open " << path;
+        return false;
+    }
+
+    std::string header;
+    int version = 0;
+    std::string keyword;
+    std::size_t count = 0;
+
+    if (!(stream >> header >> version >> keyword >> count)
+     || header != RECORDING_HEADER
+     || version != RECORDING_VERSION
+     || keyword != "initial")
+    {
+        ofLogError("SyntheticNetworkInterfaceSource::load") << "Not a recording: " << path;
+        return false;
+    }
+
+    recording.initial.resize(count);
+
+    for (auto& info: recording.initial)
+    {
+        if (!readInterface(stream, info))
+        {
+            ofLogError("SyntheticNetworkInterfaceSource::load") << "Invalid interface in " << path;
+            return false;
+        }
+    }
+
+    std::sort(recording.initial.begin(), recording.initial.end(), byIndex);
+
+    std::size_t removed = 0;
+
+    while (stream >> keyword >> count >> removed)
+    {
+        Change change;
+
+        if (keyword != "change")
+        {
+            ofLogError("SyntheticNetworkInterfaceSource::load") << "Invalid change in " << path;
+            return false;
+        }
+
+        change.removed.resize(removed);
+
+        for (auto& index: change.removed)
+        {
+            if (!(stream >> index))
+            {
+                ofLogError("SyntheticNetworkInterfaceSource::load") << "Invalid change in " << path;
+                return false;
+            }
+        }
+
+        change.updated.resize(count);
+
+        for (auto& info: change.updated)
+        {
+            if (!readInterface(stream, info))
+            {
+                ofLogError("SyntheticNetworkInterfaceSource::load") << "Invalid interface in " << path;
+                return false;
+            }
+        }
+
+        recording.changes.push_back(std::move(change));
+    }
+
+    return stream.eof();
+}
+
+
+} } // namespace ofx::Net
@@ -22,8 +22,30 @@
 #include "Poco/Net/HTTPClientSession.h"
 #include "Poco/Net/HTTPRequest.h"
 #include "Poco/Net/HTTPResponse.h"
+#include "ofx/Net/AsyncHostResolver.h"
+#include "ofx/Net/HostEntryCache.h"
+#include "ofx/Net/HostsTable.h"
+#include "ofx/Net/IPAddressBits.h"
+#include "ofx/Net/CompactIPAddress.h"
+#include "ofx/Net/CompactIPAddressRange.h"
 #include "ofx/Net/IPAddressRange.h"
+#include "ofx/Net/IPAddressRangeBatch.h"
+#include "ofx/Net/IPAddressRangeParser.h"
+#include "ofx/Net/IPAddressRangeTable.h"
+#include "ofx/Net/IPAddressRangeUtils.h"
+#include "ofx/Net/IPAddressSequence.h"
+#include "ofx/Net/IPv4AddressRangeTable.h"
+#include "ofx/Net/LockFreeQueue.h"
+#include "ofx/Net/MappedIPAddressRangeTable.h"
+#include "ofx/Net/NetworkInterfaceEnumerator.h"
+#include "ofx/Net/NetworkInterfaceEvent.h"
+#include "ofx/Net/NetworkInterfaceFilter.h"
+#include "ofx/Net/NetworkInterfaceInfo.h"
+#include "ofx/Net/NetworkInterfaceQuery.h"
+#include "ofx/Net/NetworkInterfaceSnapshot.h"
+#include "ofx/Net/NetworkInterfaceSource.h"
 #include "ofx/Net/NetworkUtils.h"
+#include "ofx/Net/SyntheticNetworkInterfaceSource.h"
 #include "ofx/Net/NetworkInterfaceListener.h"
 
 